@@ -0,0 +1,110 @@
+/* bits.cc
+ *
+ * Implementation of the classes BitWriter and BitReader, used for
+ * compressing to and decompressing from buffers and streams.
+ */
+
+#include "huffman.h"
+
+BitWriter::BitWriter(char * buffer, size_t capacity)
+: _buffer(buffer), _capacity(capacity), _length(0),
+  _pending(0), _pendingCount(0)
+{ }
+
+bool BitWriter::insertBits(unsigned bits, int count)
+{
+    // Bits not yet written are kept in the low _pendingCount bits of
+    // _pending; fewer than 8 are left between calls, so it never overflows
+
+    _pending = (_pending << count) | bits;
+    _pendingCount += count;
+    while (_pendingCount >= BITS_PER_CHARACTER)
+    {
+        if (_length == _capacity)
+            return false;
+        _pendingCount -= BITS_PER_CHARACTER;
+        _buffer[_length ++] = (char) (_pending >> _pendingCount);
+    }
+    return true;
+}
+
+bool BitWriter::flushBits()
+{
+    if (_pendingCount > 0)
+        return insertBits(0, BITS_PER_CHARACTER - _pendingCount);
+    return true;
+}
+
+size_t BitWriter::length() const
+{ return _length; }
+
+void BitWriter::restart(char * buffer, size_t capacity)
+{
+    _buffer = buffer;
+    _capacity = capacity;
+    _length = 0;
+}
+
+BitReader::BitReader(const char * buffer, size_t length)
+: _buffer(buffer), _length(length), _consumed(0),
+  _pending(0), _pendingCount(0)
+{ }
+
+int BitReader::extractBit()
+{
+    if (_pendingCount == 0)
+    {
+        refill();
+        if (_pendingCount == 0)
+            return -1;
+    }
+    _pendingCount --;
+    return (_pending >> _pendingCount) & 1;
+}
+
+bool BitReader::extractBits(int count, unsigned & bits)
+{
+    bits = peekBits(count);
+    return skipBits(count);
+}
+
+unsigned BitReader::peekBits(int count)
+{
+    if (_pendingCount < count)
+        refill();
+    unsigned long long mask = (1ULL << count) - 1;
+    if (_pendingCount >= count)
+        return (_pending >> (_pendingCount - count)) & mask;
+    return (_pending << (count - _pendingCount)) & mask;
+}
+
+bool BitReader::skipBits(int count)
+{
+    if (_pendingCount < count)
+    {
+        refill();
+        if (_pendingCount < count)
+            return false;
+    }
+    _pendingCount -= count;
+    return true;
+}
+
+void BitReader::restart(const char * buffer, size_t length)
+{
+    _buffer = buffer;
+    _length = length;
+    _consumed = 0;
+}
+
+void BitReader::refill()
+{
+    // Bits not yet extracted are the low _pendingCount bits of _pending
+
+    while (_pendingCount <= 64 - BITS_PER_CHARACTER && _consumed < _length)
+    {
+        _pending = (_pending << BITS_PER_CHARACTER) |
+                   (unsigned char) _buffer[_consumed ++];
+        _pendingCount += BITS_PER_CHARACTER;
+    }
+}
@@ -0,0 +1,175 @@
+/* canonical.cc
+ *
+ * Implementation of the class CanonicalCode, declared in huffman.h
+ */
+
+#include "huffman.h"
+#include <algorithm>
+#include <cstring>
+
+CanonicalCode::CanonicalCode()
+{
+    unsigned char lengths[UCHAR_MAX + 1] = { 0 };
+    fillInFromLengths(lengths);
+}
+
+bool CanonicalCode::computeLengths(const int frequencies[UCHAR_MAX + 1],
+                                   unsigned char lengths[UCHAR_MAX + 1])
+{
+    // Sort the characters that occur by frequency, ties by character, with
+    // each key holding the frequency above the character
+
+    unsigned long long keys[UCHAR_MAX + 1];
+    int present = 0;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+    {
+        lengths[c] = 0;
+        if (frequencies[c] > 0)
+            keys[present ++] =
+                (unsigned long long) frequencies[c] << 8 | c;
+    }
+    if (present == 0)
+        return true;
+    if (present == 1)
+    {
+        int c = keys[0] & UCHAR_MAX;
+        lengths[c] = lengths[(c + 1) & UCHAR_MAX] = 1;
+        return true;
+    }
+    sort(keys, keys + present);
+
+    // Nodes 0 .. present - 1 are the leaves, in order of frequency, and the
+    // rest are internal nodes, in the order made.  Internal nodes are made
+    // in order of increasing weight, so the two lightest remaining nodes
+    // are always at the front of one or other of the two groups.
+
+    unsigned long long weight[2 * (UCHAR_MAX + 1)];
+    int parent[2 * (UCHAR_MAX + 1)];
+    int nextLeaf = 0, nextInternal = present;
+    for (int i = 0; i < present; i ++)
+        weight[i] = keys[i] >> 8;
+    for (int node = present; node < 2 * present - 1; node ++)
+    {
+        weight[node] = 0;
+        for (int child = 0; child < 2; child ++)
+        {
+            int lightest;
+            if (nextLeaf < present &&
+                (nextInternal == node || weight[nextLeaf] <= weight[nextInternal]))
+                lightest = nextLeaf ++;
+            else
+                lightest = nextInternal ++;
+            weight[node] += weight[lightest];
+            parent[lightest] = node;
+        }
+    }
+
+    // The depth of each node is one more than that of its parent, which
+    // was made later
+
+    int depth[2 * (UCHAR_MAX + 1)];
+    depth[2 * present - 2] = 0;
+    for (int node = 2 * present - 3; node >= 0; node --)
+        depth[node] = depth[parent[node]] + 1;
+    for (int i = 0; i < present; i ++)
+    {
+        if (depth[i] > MAX_CODE_LENGTH)
+            return false;
+        lengths[keys[i] & UCHAR_MAX] = depth[i];
+    }
+    return true;
+}
+
+bool CanonicalCode::fillInFromLengths(const unsigned char lengths[UCHAR_MAX + 1])
+{
+    memset(_count, 0, sizeof(_count));
+    memset(_lengthCount, 0, sizeof(_lengthCount));
+    memset(_table, 0, sizeof(_table));
+
+    // Check that the lengths describe a complete prefix code, as
+    // HuffmanTree::fillInFromLengths does
+
+    unsigned long long kraftSum = 0;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+    {
+        if (lengths[c] > MAX_CODE_LENGTH)
+            return false;
+        if (lengths[c] > 0)
+            kraftSum += 1ULL << (MAX_CODE_LENGTH - lengths[c]);
+    }
+    if (kraftSum != 1ULL << MAX_CODE_LENGTH)
+        return false;
+
+    // Assign codes in order of length, and of character within a length
+
+    int longest = 0;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+        longest = max(longest, (int) lengths[c]);
+    int present = 0;
+    unsigned code = 0;
+    for (int length = 1; length <= longest; length ++)
+    {
+        for (int c = 0; c <= UCHAR_MAX; c ++)
+            if (lengths[c] == length)
+            {
+                _bits[c] = code ++;
+                _count[c] = length;
+                _sorted[present ++] = c;
+                _lengthCount[length] ++;
+
+                // Every TABLE_BITS-bit value starting with a short code
+                // decodes to its character
+
+                if (length <= TABLE_BITS)
+                {
+                    int first = _bits[c] << (TABLE_BITS - length);
+                    int last = first + (1 << (TABLE_BITS - length));
+                    for (int i = first; i < last; i ++)
+                        _table[i] = length << 8 | c;
+                }
+            }
+        code <<= 1;
+    }
+    return true;
+}
+
+bool CanonicalCode::encode(char character, BitWriter & output) const
+{
+    unsigned char c = character;
+    if (_count[c] == 0)
+        return false;
+    return output.insertBits(_bits[c], _count[c]);
+}
+
+bool CanonicalCode::decode(BitReader & input, char & character) const
+{
+    unsigned short entry = _table[input.peekBits(TABLE_BITS)];
+    if (entry != 0)
+    {
+        character = entry & UCHAR_MAX;
+        return input.skipBits(entry >> 8);
+    }
+
+    // A longer code: the codes of each length are consecutive, starting
+    // where the codes of the previous length leave off (doubled), so read
+    // a bit at a time until the code read is within the range of its length
+
+    unsigned code = 0, first = 0;
+    int index = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; length ++)
+    {
+        int bit = input.extractBit();
+        if (bit < 0)
+            return false;
+        code |= bit;
+        if (code - first < (unsigned) _lengthCount[length])
+        {
+            character = _sorted[index + code - first];
+            return true;
+        }
+        index += _lengthCount[length];
+        first = (first + _lengthCount[length]) << 1;
+        code <<= 1;
+    }
+    return false;
+}
@@ -6,6 +6,7 @@
  */
  
 #include "huffman.h"
+#include "lz.h"
 #include <fstream>
 #include <string.h>
 
@@ -16,9 +17,13 @@ void usage()
     cout << "huffman -f treefile originalDocument" << endl;
     cout << "huffman -c treefile originalDocument compressedDocument" << endl;
     cout << "huffman -d treefile compressedDocument decompressedDocument" << endl;
+    cout << "huffman -z originalDocument compressedDocument" << endl;
+    cout << "huffman -x compressedDocument decompressedDocument" << endl;
     cout << "-f form creates a tree file based on character frequencies in " <<
                 "a document" << endl;
     cout << "-c compresses a document; -d decompresses" << endl;
+    cout << "-z compresses a document with an LZ77 stage and codes of its " <<
+                "own; -x decompresses" << endl;
 }
 
 /* Main program */
@@ -58,6 +63,14 @@ int main(int argc, char ** argv)
                     return 1;
                 }
                 
+                if (! theTree.canWrite())
+                {
+                    cerr << "Document uses the tree file's internal node "
+                            "marker, so its tree cannot be written: "
+                         << argv[3] << endl;
+                    return 1;
+                }
+                
                 ofstream treefile(argv[2], ios::out | ios::binary);
                 if (treefile.good())
                 {
@@ -95,7 +108,7 @@ int main(int argc, char ** argv)
                     theTree.read(treefile);
                     char expectedEOF;
                     treefile.get(expectedEOF);
-                    if (treefile.eof())
+                    if (! theTree.isEmpty() && treefile.eof())
                         treefile.close();
                     else
                     {
@@ -110,6 +123,13 @@ int main(int argc, char ** argv)
                     return 1;
                 }
                 
+                if (! theTree.canCompress())
+                {
+                    cerr << "Tree too deep to compress with: "
+                         << argv[2] << endl;
+                    return 1;
+                }
+                
                 ifstream originalDocument(argv[3]);
                 ofstream compressedDocument(argv[4], ios::out | ios::binary);
                 if (originalDocument.good() && compressedDocument.good())
@@ -121,6 +141,12 @@ int main(int argc, char ** argv)
                         compressedDocument.close();
                         return 0;
                     }
+                    else if (originalDocument.good())
+                    {
+                        cerr << "Document uses a character not in the tree: "
+                             << argv[3] << endl;
+                        return 1;
+                    }
                     else if (! originalDocument.eof())
                     {
                         cerr << "Error reading file: " << argv[3] << endl;
@@ -160,7 +186,7 @@ int main(int argc, char ** argv)
                     theTree.read(treefile);
                     char expectedEOF;
                     treefile.get(expectedEOF);
-                    if (treefile.eof())
+                    if (! theTree.isEmpty() && treefile.eof())
                         treefile.close();
                     else
                     {
@@ -224,6 +250,105 @@ int main(int argc, char ** argv)
                 return 1;
             }
             
+        case 'z':
+        
+            if (argc == 4)
+            {
+                ifstream originalDocument(argv[2], ios::in | ios::binary);
+                ofstream compressedDocument(argv[3], ios::out | ios::binary);
+                if (originalDocument.good() && compressedDocument.good())
+                {
+                    LZCompressor compressor;
+                    compressor.compress(originalDocument, compressedDocument);
+                    if (originalDocument.eof() && compressedDocument.good())
+                    {
+                        originalDocument.close();
+                        compressedDocument.close();
+                        return 0;
+                    }
+                    else if (! originalDocument.eof())
+                    {
+                        cerr << "Error reading file: " << argv[2] << endl;
+                        return 1;
+                    }
+                    else
+                    {
+                        cerr << "Error writing file: " << argv[3] << endl;
+                        return 1;
+                    }
+                }
+                else if (originalDocument.fail())
+                {
+                    cerr << "Error opening file: " << argv[2] << endl;
+                    return 1;
+                }
+                else 
+                {
+                    cerr << "Error creating file: " << argv[3] << endl;
+                    return 1;
+                }
+            }
+            else
+            {
+                usage();
+                return 1;
+            }
+        
+        case 'x':
+        
+            if (argc == 4)
+            {
+                ifstream compressedDocument(argv[2], ios::in | ios::binary);
+                ofstream decompressedDocument(argv[3], ios::out | ios::binary);
+                if (compressedDocument.good() && decompressedDocument.good())
+                {
+                    LZCompressor compressor;
+                    compressor.decompress(compressedDocument,
+                                          decompressedDocument);
+                    if (compressedDocument.good() && decompressedDocument.good())
+                    {
+                        char junk;
+                        compressedDocument.get(junk);   // Force eof
+                        if (compressedDocument.eof())
+                        {
+                            compressedDocument.close();
+                            decompressedDocument.close();
+                            return 0;
+                        }
+                        else
+                        {
+                            cerr << "Wrong format reading file: " << argv[2] << endl;
+                            return 1;
+                        }
+                    }
+                    else if (! compressedDocument.good())
+                    {
+                        cerr << "Wrong format reading file: " << argv[2] << endl;
+                        return 1;
+                    }
+                    else
+                    {
+                        cerr << "Error writing file: " << argv[3] << endl;
+                        return 1;
+                    }
+                }
+                else if (compressedDocument.fail())
+                {
+                    cerr << "Error opening file: " << argv[2] << endl;
+                    return 1;
+                }
+                else 
+                {
+                    cerr << "Error creating file: " << argv[3] << endl;
+                    return 1;
+                }
+            }
+            else
+            {
+                usage();
+                return 1;
+            }
+            
         default:
         
             usage();
@@ -8,48 +8,189 @@
  */
 
 #include "huffman.h"
-#include <climits>
+#include <cstdio>
+#include <queue>
+#include <vector>
 
 HuffmanTree::HuffmanTree()
 : _root(NULL)
-{ }
+{
+    createCodeTable();
+}
+
+HuffmanTree::~HuffmanTree()
+{
+    delete _root;
+}
+
+bool HuffmanTree::isEmpty() const
+{
+    return _root == NULL;
+}
 
 void HuffmanTree::read(istream & treefile)
 {
-    _root = Node::read(treefile);
+    setRoot(Node::read(treefile));
+
+    // Without an EOF_CHAR, decompressing could never finish
+
+    if (_count[(unsigned char) EOF_CHAR] < 0)
+    {
+        setRoot(NULL);
+        treefile.setstate(ios::failbit);
+    }
+}
+
+bool HuffmanTree::canCompress() const
+{
+    return _longestCode >= 0 && _count[(unsigned char) EOF_CHAR] >= 0;
 }
 
 void HuffmanTree::write(ostream & treefile) const
 {
-    _root -> write(treefile);
+    if (! canWrite())
+        treefile.setstate(ios::failbit);
+    else if (_root != NULL)
+        _root -> write(treefile);
 }
 
-#ifndef PROFESSOR_VERSION
+bool HuffmanTree::canWrite() const
+{
+    return _count[(unsigned char) INTERNAL_NODE_MARKER] < 0;
+}
 
-// Fills in  a Huffman Tree using character frequency data in a document
-// Includes one instance of the EOF_CHAR.
-// Uses preorder traversal of the tree.
-// When a leaf is encountered, the character stored there will be written to the
-//file. When internal node is encountered, a special character is written to file.
-void HuffmanTree::fillIn(istream & document)
+void HuffmanTree::fillIn(const char * document, size_t length)
 {
+    int frequencies[UCHAR_MAX + 1] = { 0 };
+    for (size_t i = 0; i < length; i ++)
+        frequencies[(unsigned char) document[i]] ++;
 
+    // Exactly one EOF_CHAR is compressed, however many the document has
 
+    frequencies[(unsigned char) EOF_CHAR] = 1;
+    fillIn(frequencies);
+}
 
+void HuffmanTree::fillIn(const int frequencies[UCHAR_MAX + 1])
+{
+    priority_queue<Node *, vector<Node *>, NodeFrequencyComparator> pending;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+        if (frequencies[c] > 0)
+            pending.push(new LeafNode((char) c, frequencies[c]));
+    if (pending.empty())
+    {
+        setRoot(NULL);
+        return;
+    }
 
+    // A lone leaf would get an empty code, which cannot be told apart from
+    // the next one, so give it a partner that is never used
 
+    if (pending.size() == 1)
+        pending.push(new LeafNode(pending.top() -> getCharacter() + 1));
 
+    // Repeatedly combine the two least frequent subtrees until one remains
 
+    while (pending.size() > 1)
+    {
+        Node * lchild = pending.top();
+        pending.pop();
+        Node * rchild = pending.top();
+        pending.pop();
+        pending.push(new InternalNode(lchild, rchild));
+    }
+    setRoot(pending.top());
+}
 
+bool HuffmanTree::fillInFromLengths(const unsigned char lengths[UCHAR_MAX + 1])
+{
+    // Check that the lengths describe a complete prefix code: the sum of
+    // 2^-length over all characters present must be exactly 1
 
+    unsigned long long kraftSum = 0;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+    {
+        if (lengths[c] > MAX_CODE_LENGTH)
+        {
+            setRoot(NULL);
+            return false;
+        }
+        if (lengths[c] > 0)
+            kraftSum += 1ULL << (MAX_CODE_LENGTH - lengths[c]);
+    }
+    if (kraftSum != 1ULL << MAX_CODE_LENGTH)
+    {
+        setRoot(NULL);
+        return false;
+    }
 
+    // Assign canonical codes: shorter codes first, and characters of the
+    // same length in increasing order, each code one more than the last
 
+    unsigned char characters[UCHAR_MAX + 1];
+    unsigned codes[UCHAR_MAX + 1];
+    unsigned char sortedLengths[UCHAR_MAX + 1];
+    int present = 0;
+    unsigned code = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; length ++)
+    {
+        for (int c = 0; c <= UCHAR_MAX; c ++)
+            if (lengths[c] == length)
+            {
+                characters[present] = c;
+                codes[present] = code ++;
+                sortedLengths[present] = length;
+                present ++;
+            }
+        code <<= 1;
+    }
 
+    setRoot(buildCanonical(characters, codes, sortedLengths,
+                           0, present - 1, 0));
+    return true;
+}
 
+HuffmanTree::Node * HuffmanTree::buildCanonical(
+                     const unsigned char characters [],
+                     const unsigned codes [],
+                     const unsigned char lengths [],
+                     int first, int last, int depth)
+{
+    if (first == last && lengths[first] == depth)
+        return new LeafNode((char) characters[first]);
+
+    // Codes are in increasing order, so those continuing with a 0 bit at
+    // this depth all precede those continuing with a 1 bit
+
+    int split = first;
+    while (split <= last &&
+           ((codes[split] >> (lengths[split] - depth - 1)) & 1) == 0)
+        split ++;
+    Node * lchild = buildCanonical(characters, codes, lengths,
+                                   first, split - 1, depth + 1);
+    Node * rchild = buildCanonical(characters, codes, lengths,
+                                   split, last, depth + 1);
+    return new InternalNode(lchild, rchild);
+}
 
+#ifndef PROFESSOR_VERSION
 
+// Fills in  a Huffman Tree using character frequency data in a document
+// Includes one instance of the EOF_CHAR.
+// Uses preorder traversal of the tree.
+// When a leaf is encountered, the character stored there will be written to the
+//file. When internal node is encountered, a special character is written to file.
+void HuffmanTree::fillIn(istream & document)
+{
+    int frequencies[UCHAR_MAX + 1] = { 0 };
+    char c;
+    while (document.get(c))
+        frequencies[(unsigned char) c] ++;
 
+    // Exactly one EOF_CHAR is compressed, however many the document has
 
+    frequencies[(unsigned char) EOF_CHAR] = 1;
+    fillIn(frequencies);
 }
 
 // Uses Huffman Tree to compress a file (according to rules of frequency, etc.)
@@ -60,32 +201,35 @@ void HuffmanTree::fillIn(istream & document)
 void HuffmanTree::compress(istream & originalDocument,
   ostream & compressedDocument) const
   {
-    int * bits;
-    int * count;
-    createCodeTable(bits, count);
-
+    if (! canCompress())
+    {
+      compressedDocument.setstate(ios::failbit);
+      return;
+    }
+    // Bits are collected in buffer, which is written out whenever it
+    // might not have room for another code
+    char buffer[BUFSIZ];
+    BitWriter output(buffer, sizeof buffer);
     char c;
     while(! originalDocument.eof())
     {
       originalDocument.get(c);
-      //originalDocument >> c;
-      std::cerr << "Got char " << c << '\n';
-      int bitsToWrite = bits[c];
-      int countToWrite = count[c];
-      if (! originalDocument.eof())
+      if (originalDocument.eof())
+        c = EOF_CHAR;
+      if (! encode(c, output))
       {
-        insertBits(compressedDocument, bitsToWrite, countToWrite);
-        std::cerr << "inserted a character; not at end" << '\n';
+        // Character does not appear in the tree - cannot be compressed
+        compressedDocument.setstate(ios::failbit);
+        return;
       }
-      else
+      if (output.length() > sizeof buffer - MAX_CODE_LENGTH / BITS_PER_CHARACTER)
       {
-        insertBits(compressedDocument, bits[EOF_CHAR], count[EOF_CHAR]);
-        std::cerr << "inserted end character" << '\n';
-        flushBits(compressedDocument);
-        std::cerr << "flushed characters" << '\n';
+        compressedDocument.write(buffer, output.length());
+        output.restart(buffer, sizeof buffer);
       }
     }
-
+    output.flushBits();
+    compressedDocument.write(buffer, output.length());
   }
 
 
@@ -101,21 +245,36 @@ void HuffmanTree::decompress(istream & compressedDocument,
       //called decompressedDocument in our code.
       // We continue doing this until we reach the EOF_CHAR; then we stop before
       //we add the EOF_CHAR to the decompressedDocument.
+    if (_count[(unsigned char) EOF_CHAR] < 0)
+    {
+      // No way to ever reach EOF_CHAR
+      compressedDocument.setstate(ios::failbit);
+      return;
+    }
+    // Characters are read one at a time, so that nothing after the
+    // compressed document is read from the stream
+    char current;
+    BitReader input(&current, 0);
     Node * currNode = _root;
     bool finished = false;
     while (!finished)
     {
       if (currNode->isInternal()) {
-        int currentBit = extractBit(compressedDocument);
-        std::cerr << "Current Bit: " << currentBit << '\n';
+        int currentBit = input.extractBit();
+        if (currentBit < 0) {
+          if (! compressedDocument.get(current)) {
+            // ran out of input before EOF_CHAR
+            return;
+          }
+          input.restart(&current, 1);
+          currentBit = input.extractBit();
+        }
         if (currentBit == 0) {
           // go left
-          std::cerr << "Going left" << '\n';
           currNode = currNode->getLChild();
         }
         else {
           // go right
-          std::cerr << "Going right" << '\n';
           currNode = currNode->getRChild();
         }
       }
@@ -123,7 +282,6 @@ void HuffmanTree::decompress(istream & compressedDocument,
       {
         // is leaf
         char newChar = currNode->getCharacter();
-        std::cerr << "New character = " << newChar << '\n';
         if (newChar != EOF_CHAR)
         {
           decompressedDocument.put(newChar);
@@ -139,74 +297,119 @@ void HuffmanTree::decompress(istream & compressedDocument,
 
 #endif
 
-void HuffmanTree::createCodeTable(int * & bits, int * & count) const
+size_t HuffmanTree::maxCompressedLength(size_t length) const
 {
-    bits = new int[CHAR_MAX + 1];
-    count = new int[CHAR_MAX + 1];
-        // +1 to allow for 0 entry
-    _root -> fillInCodeTable(bits, count, 0, 0);
+    if (! canCompress())
+        return 0;
+    // Every character, plus the EOF_CHAR, takes at most _longestCode bits
+    return (length + 1) / BITS_PER_CHARACTER * _longestCode +
+           ((length + 1) % BITS_PER_CHARACTER * _longestCode) /
+               BITS_PER_CHARACTER + 1;
 }
 
-// Global variables used by bit operations
-
-#define BITS_PER_CHARACTER 8
-
-static int bitsExtracted = BITS_PER_CHARACTER ;
-static int bitsInserted = 0;
-static char currentExtractChar, currentInsertChar;
-
-int HuffmanTree::extractBit(istream & input)
+HuffmanTree::Result HuffmanTree::compress(const char * originalDocument,
+                                          size_t length,
+                                          char * compressedDocument,
+                                          size_t capacity,
+                                          size_t & compressedLength) const
 {
-    // Read a single character if need be
+    compressedLength = 0;
+
+    // Check every character before encoding any, so that a document the
+    // tree cannot encode is reported as such however small the buffer.  An
+    // EOF_CHAR would end the document early when decompressed.
+
+    if (! canCompress())
+        return BAD_INPUT;
+    for (size_t i = 0; i < length; i ++)
+        if (originalDocument[i] == EOF_CHAR ||
+            _count[(unsigned char) originalDocument[i]] < 0)
+            return BAD_INPUT;
+
+    BitWriter output(compressedDocument, capacity);
+    for (size_t i = 0; i < length; i ++)
+        if (! encode(originalDocument[i], output))
+            return NO_ROOM;
+    if (! encode(EOF_CHAR, output) || ! output.flushBits())
+        return NO_ROOM;
+    compressedLength = output.length();
+    return OK;
+}
 
-    if (bitsExtracted >= BITS_PER_CHARACTER)
+HuffmanTree::Result HuffmanTree::decompress(const char * compressedDocument,
+                                            size_t length,
+                                            char * decompressedDocument,
+                                            size_t capacity,
+                                            size_t & decompressedLength) const
+{
+    BitReader input(compressedDocument, length);
+    decompressedLength = 0;
+    if (_count[(unsigned char) EOF_CHAR] < 0)
+        return BAD_INPUT;
+    char character;
+    while (decode(input, character))
     {
-        input.get(currentExtractChar);
-        bitsExtracted = 0;
+        if (character == EOF_CHAR)
+            return OK;
+        if (decompressedLength == capacity)
+            return NO_ROOM;
+        decompressedDocument[decompressedLength ++] = character;
     }
+    return BAD_INPUT;
+}
 
-    // Extract next bit from current character
-
-    int result = ((signed char) currentExtractChar) < 0; // Means leftmost bit 1
-    currentExtractChar <<= 1;
-    bitsExtracted ++;
-    return result;
+bool HuffmanTree::encode(char character, BitWriter & output) const
+{
+    unsigned char c = character;
+    if (_count[c] < 0 || _longestCode < 0)
+        return false;
+    return output.insertBits(_bits[c], _count[c]);
 }
 
-void HuffmanTree::insertBits(ostream & output, int bits, int count)
+bool HuffmanTree::decode(BitReader & input, char & character) const
 {
-    for (int i = count - 1; i >= 0; i --)
+    if (_root == NULL)
+        return false;
+    const Node * currNode = _root;
+    while (currNode -> isInternal())
     {
-        // Insert bit at position i into current character
-
-        currentInsertChar <<= 1;
-        currentInsertChar |= ((bits & (1 << i)) != 0);
-        bitsInserted ++;
-
-        // Write character if full
-
-        if (bitsInserted >= BITS_PER_CHARACTER)
-        {
-            output.put(currentInsertChar);
-            bitsInserted = 0;
-        }
+        int currentBit = input.extractBit();
+        if (currentBit < 0)
+            return false;
+        currNode = currentBit ? currNode -> getRChild()
+                              : currNode -> getLChild();
     }
+    character = currNode -> getCharacter();
+    return true;
 }
 
-void HuffmanTree::flushBits(ostream & output)
+void HuffmanTree::setRoot(Node * root)
 {
-    if (bitsInserted > 0)
-    {
-        // This loop effectively inserts 0's until currentInsertChar is full,
-        // putting the first "real" bit in the leftmost position
+    delete _root;
+    _root = root;
+    createCodeTable();
+}
 
-        while (bitsInserted < BITS_PER_CHARACTER)
-        {
-            currentInsertChar <<= 1;
-            bitsInserted ++;
-        }
-        output.put(currentInsertChar);
+void HuffmanTree::createCodeTable()
+{
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+    {
+        _bits[c] = 0;
+        _count[c] = -1;
+    }
+    if (_root == NULL)
+    {
+        _longestCode = -1;
+        return;
     }
+    _root -> fillInCodeTable(_bits, _count, 0, 0);
+
+    _longestCode = 0;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+        if (_count[c] > _longestCode)
+            _longestCode = _count[c];
+    if (_longestCode > MAX_CODE_LENGTH)
+        _longestCode = -1;
 }
 
 #ifdef PROFESSOR_VERSION
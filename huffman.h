@@ -5,39 +5,209 @@
  * Copyright (c) 2013 - Russell C. Bjork
  */
 
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
 #include <iostream>
+#include <climits>
+#include <cstddef>
 using namespace std;
 
+/* Longest code a tree can use and still be used for compressing.  Codes are
+ * kept in an unsigned int, so this must not exceed its width. */
+#define MAX_CODE_LENGTH 32
+
+#define BITS_PER_CHARACTER 8
+
+/* Writes bits into a caller-supplied buffer, filling each character from
+ * its leftmost bit.  Never writes past the end of the buffer. */
+class BitWriter
+{
+    public:
+    
+        /* Constructor - buffer is initially empty */
+        BitWriter(char * buffer, size_t capacity);
+        /* Write the low count bits of bits, leftmost first.  count must not
+         * exceed MAX_CODE_LENGTH.  Returns false if there is not enough
+         * room, in which case the writer should no longer be used. */
+        bool insertBits(unsigned bits, int count);
+        /* Pad the last partial character with 0's and write it */
+        bool flushBits();
+        /* Number of complete characters written so far */
+        size_t length() const;
+        /* Continue writing into a new buffer, e.g. once the complete
+         * characters of the old one have been copied elsewhere.  Bits not
+         * yet written are kept. */
+        void restart(char * buffer, size_t capacity);
+    private:
+    
+        char * _buffer;
+        size_t _capacity, _length;
+        unsigned long long _pending;
+        int _pendingCount;
+};
+
+/* Reads bits written by a BitWriter from a buffer */
+class BitReader
+{
+    public:
+    
+        /* Constructor - reading starts at the first bit of buffer */
+        BitReader(const char * buffer, size_t length);
+        /* Extract the next bit, or return -1 at the end of the buffer */
+        int extractBit();
+        /* Extract the next count bits into bits.  count must not exceed
+         * MAX_CODE_LENGTH.  Returns false at the end of the buffer. */
+        bool extractBits(int count, unsigned & bits);
+        /* Get the next count bits without extracting them, padded with 0's
+         * past the end of the buffer */
+        unsigned peekBits(int count);
+        /* Extract and discard count bits.  Returns false at the end of the
+         * buffer. */
+        bool skipBits(int count);
+        /* Continue reading from a new buffer once this one is used up.
+         * Bits not yet extracted are kept. */
+        void restart(const char * buffer, size_t length);
+    private:
+    
+        /* Move characters from the buffer into _pending while there is
+         * room */
+        void refill();
+        
+        const char * _buffer;
+        size_t _length, _consumed;
+        unsigned long long _pending;
+        int _pendingCount;
+};
+
+/* A canonical Huffman code held entirely in fixed-size tables, for coding
+ * with a fresh code for each block of data without building a tree of
+ * nodes.  Codes are assigned as by HuffmanTree::fillInFromLengths. */
+class CanonicalCode
+{
+    public:
+    
+        /* Constructor for an empty code */
+        CanonicalCode();
+        /* Compute the code lengths of a Huffman code for the given counts
+         * of occurrences of each character, used as given.  Characters that
+         * do not occur get length 0, except that a lone character is given
+         * a partner so that its code is not empty.  Returns false if some
+         * code would be longer than MAX_CODE_LENGTH. */
+        static bool computeLengths(const int frequencies[UCHAR_MAX + 1],
+                                   unsigned char lengths[UCHAR_MAX + 1]);
+        /* Set up the code having the given code length for each character
+         * (0 meaning the character does not occur).  Returns false, leaving
+         * the code empty, if the lengths do not form a complete prefix code
+         * of at most MAX_CODE_LENGTH bits. */
+        bool fillInFromLengths(const unsigned char lengths[UCHAR_MAX + 1]);
+        /* Write the code for a single character.  Returns false if the
+         * character has no code or there is not enough room. */
+        bool encode(char character, BitWriter & output) const;
+        /* Read a single character.  Returns false if the input ends first
+         * or the code is empty. */
+        bool decode(BitReader & input, char & character) const;
+    private:
+    
+        /* Codes up to this long are decoded by a single lookup in _table */
+        enum { TABLE_BITS = 10 };
+        
+        /* Code and its length for each character, for encoding */
+        unsigned _bits[UCHAR_MAX + 1];
+        unsigned char _count[UCHAR_MAX + 1];
+        /* Number of codes of each length, and the characters in order of
+         * their codes, for decoding codes longer than TABLE_BITS */
+        int _lengthCount[MAX_CODE_LENGTH + 1];
+        unsigned char _sorted[UCHAR_MAX + 1];
+        /* For each value of the next TABLE_BITS bits, the character whose
+         * code they start with (low 8 bits) and the length of that code
+         * (high bits), or 0 if the code is longer */
+        unsigned short _table[1 << TABLE_BITS];
+};
+
 class HuffmanTree
 {
     public:
     
+        /* Results of the buffer forms of compress and decompress */
+        enum Result { OK, NO_ROOM, BAD_INPUT };
+        
         /* Constructor for an empty tree */
         HuffmanTree();      
-        /* Read contents of tree from a file. */
+        /* Destructor - frees all nodes of the tree */
+        ~HuffmanTree();
+        /* Test to see whether this tree has any contents yet */
+        bool isEmpty() const;
+        /* Read contents of tree from a file.  On a malformed file, or one
+         * whose tree has no EOF_CHAR, the tree is left empty and the
+         * stream's failbit is set. */
         void read(istream & treefile);
-        /* Write this tree to a file that can be read by read. */
+        /* Write this tree to a file that can be read by read.  If the tree
+         * cannot be written (see canWrite), nothing is written and the
+         * stream's failbit is set. */
         void write(ostream & treefile) const;
+        /* Test to see whether this tree can be written to a file - it must
+         * have no leaf for INTERNAL_NODE_MARKER, which read would take for
+         * an internal node */
+        bool canWrite() const;
         /* Fill in tree based on the characters occurring in a document. */
         void fillIn(istream & document);
-        /* Compress a document using this tree.  */
+        /* Fill in tree based on the characters occurring in a buffer. */
+        void fillIn(const char * document, size_t length);
+        /* Fill in tree from a count of occurrences of each character, used
+         * as given - unlike the forms above, no EOF_CHAR is added.  The
+         * tree is left empty if no character occurs. */
+        void fillIn(const int frequencies[UCHAR_MAX + 1]);
+        /* Fill in tree as the canonical code having the given code length
+         * for each character (0 meaning the character does not occur).
+         * Returns false, leaving the tree empty, if the lengths do not form
+         * a complete prefix code of at most MAX_CODE_LENGTH bits. */
+        bool fillInFromLengths(const unsigned char lengths[UCHAR_MAX + 1]);
+        /* Test to see whether this tree can be used for compressing - it
+         * must have an EOF_CHAR and no code longer than MAX_CODE_LENGTH */
+        bool canCompress() const;
+        /* Compress a document using this tree.  If the tree cannot be used
+         * for compressing, or the document has a character not in the tree,
+         * sets the failbit of compressedDocument, leaving originalDocument
+         * good. */
         void compress(istream & originalDocument, 
                       ostream & compressedDocument) const;
         /* Decompress a document that was compressed by the above. */
         void decompress(istream & compressedDocument, 
                         ostream & decompressedDocument) const;
+        /* Largest number of bytes compress can produce for a buffer of the
+         * given length, or 0 if this tree cannot be used for compressing. */
+        size_t maxCompressedLength(size_t length) const;
+        /* Compress a buffer into a caller-supplied buffer, producing the
+         * same bytes as the stream form.  Returns BAD_INPUT if the tree
+         * cannot be used for compressing or the document has a character
+         * not in the tree or an EOF_CHAR, whatever the capacity, and
+         * otherwise NO_ROOM if there is not enough room. */
+        Result compress(const char * originalDocument, size_t length,
+                        char * compressedDocument, size_t capacity,
+                        size_t & compressedLength) const;
+        /* Write the code for a single character.  Returns false if the
+         * character is not in the tree or there is not enough room. */
+        bool encode(char character, BitWriter & output) const;
+        /* Read a single character.  Returns false if the input ends first
+         * or the tree is empty. */
+        bool decode(BitReader & input, char & character) const;
+        /* Decompress a buffer into a caller-supplied buffer.  Returns
+         * NO_ROOM only when the document is longer than capacity, and
+         * BAD_INPUT if the input ends before EOF_CHAR; either way
+         * decompressedLength is the number of characters produced. */
+        Result decompress(const char * compressedDocument, size_t length,
+                          char * decompressedDocument, size_t capacity,
+                          size_t & decompressedLength) const;
     private:
     
-        /* Create a code table to facilitate compressing a file.  Entries for
-         * characters not represented by this table will not be filled in and
-         * should not be used. */
-        void createCodeTable(int * & bits, int * & count) const;
-        /* Extract the next bit from a binary input stream */
-        static int extractBit(istream & input);
-        /* Write count of bits to a binary output stream */
-        static void insertBits(ostream & output, int bits, int count);
-        /* Flush any bits not yet output to the stream */
-        static void flushBits(ostream & output); 
+        /* Trees own their nodes, so they may not be copied */
+        HuffmanTree(const HuffmanTree &);
+        HuffmanTree & operator = (const HuffmanTree &);
+        
+        /* Fill in the code table used for compressing.  Entries for
+         * characters not represented by this tree get a count of -1. */
+        void createCodeTable();
         
         /* A node in a Huffman tree.  The nodes are of two kinds: internal 
          * nodes that have two children, and leaves that store a key.  Both 
@@ -47,6 +217,8 @@ class HuffmanTree
         {
             public:
         
+                /* Destructor - frees the subtree rooted at this node */
+                virtual ~Node();
                 /* Test to see whether this node is an internal node */
                 virtual bool isInternal() const = 0;
                 /* Get the total frequency of occurrence of the characters
@@ -67,15 +239,16 @@ class HuffmanTree
                  * arrays of entries; bitsSoFar and countSoFar are the portion 
                  * of the code that has already been determined by ancestor 
                  * nodes. */
-                virtual void fillInCodeTable(int bits [],
+                virtual void fillInCodeTable(unsigned bits [],
                                              int count [],
-                                             int bitsSoFar,
+                                             unsigned bitsSoFar,
                                              int countSoFar) const = 0;
                 /* Write the subtree rooted at this node to a file */
                 virtual void write(ostream & treefile) const = 0;
                 /* Read a subtree that has been written by write and return 
-                 * pointer to root node. */
-                static Node * read(istream & treefile);
+                 * pointer to root node, or NULL if the file is malformed.
+                 * depth is the depth of the subtree within the whole tree. */
+                static Node * read(istream & treefile, int depth = 0);
         };
 
         class InternalNode : public Node
@@ -84,14 +257,15 @@ class HuffmanTree
         
                 /* Constructor */
                 InternalNode(Node * lchild, Node * rchild);
+                ~InternalNode();
                 bool isInternal() const;
                 int getFrequency() const;
                 void write(ostream & treefile) const;
                 Node * getLChild() const;
                 Node * getRChild() const;
-                void fillInCodeTable(int bits [],
+                void fillInCodeTable(unsigned bits [],
                                      int count [],
-                                     int bitsSoFar,
+                                     unsigned bitsSoFar,
                                      int countSoFar) const;
             private:
     
@@ -110,9 +284,9 @@ class HuffmanTree
                 int getFrequency() const;
                 void write(ostream & treefile) const;               
                 char getCharacter() const;
-                void fillInCodeTable(int bits [],
+                void fillInCodeTable(unsigned bits [],
                                      int count [],
-                                     int bitsSoFar,
+                                     unsigned bitsSoFar,
                                      int countSoFar) const; 
             private:
 
@@ -130,10 +304,32 @@ class HuffmanTree
                 bool operator()(Node * a, Node * b);
         };
         
+        /* Replace the contents of this tree, freeing the old nodes and
+         * rebuilding the code table */
+        void setRoot(Node * root);
+        /* Build the subtree for a canonical code - used by
+         * fillInFromLengths */
+        static Node * buildCanonical(const unsigned char characters [],
+                                     const unsigned codes [],
+                                     const unsigned char lengths [],
+                                     int first, int last, int depth);
+        
         /* The root of this tree */
         Node * _root;
+        /* Code table used for compressing, indexed by unsigned character */
+        unsigned _bits[UCHAR_MAX + 1];
+        int _count[UCHAR_MAX + 1];
+        /* Length of the longest code, or -1 if some code is too long to fit
+         * in _bits (or the tree is empty) */
+        int _longestCode;
 };
 
 /* Character to be compressed and then used to mark end of a compressed file */
 #define EOF_CHAR '\004'
-        
+
+/* Character marking an internal node in a tree file */
+#ifndef INTERNAL_NODE_MARKER
+#define INTERNAL_NODE_MARKER '\377'
+#endif
+
+#endif
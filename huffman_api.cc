@@ -0,0 +1,236 @@
+/* huffman_api.cc
+ *
+ * Implementation of the C interface declared in huffman_api.h, as a thin
+ * wrapper around HuffmanTree.
+ */
+
+#include "huffman_api.h"
+#include "huffman.h"
+#include "lz.h"
+#include <new>
+#include <sstream>
+#include <string>
+
+struct huffman_tree
+{
+    HuffmanTree tree;
+};
+
+struct huffman_lz
+{
+    LZCompressor compressor;
+};
+
+/* A stream buffer reading from or writing to a caller's buffer in place,
+ * so that the stream forms of LZCompressor can be used without copying */
+class MemoryBuffer : public streambuf
+{
+    public:
+    
+        MemoryBuffer(char * buffer, size_t length)
+        {
+            setg(buffer, buffer, buffer + length);
+            setp(buffer, buffer + length);
+        }
+        
+        /* Number of characters written so far */
+        size_t written() const
+        { return pptr() - pbase(); }
+};
+
+/* The result code for a result of HuffmanTree's buffer methods */
+static int status(HuffmanTree::Result result)
+{
+    switch (result)
+    {
+        case HuffmanTree::OK:
+            return HUFFMAN_OK;
+        case HuffmanTree::NO_ROOM:
+            return HUFFMAN_NO_ROOM;
+        default:
+            return HUFFMAN_BAD_INPUT;
+    }
+}
+
+huffman_tree * huffman_tree_from_bytes(const unsigned char * document,
+                                       size_t length)
+{
+    huffman_tree * result = new (nothrow) huffman_tree;
+    if (result == NULL)
+        return NULL;
+    try
+    {
+        result -> tree.fillIn((const char *) document, length);
+    }
+    catch (bad_alloc &)
+    {
+        delete result;
+        return NULL;
+    }
+    return result;
+}
+
+huffman_tree * huffman_tree_from_lengths(const unsigned char lengths[256])
+{
+    huffman_tree * result = new (nothrow) huffman_tree;
+    if (result == NULL)
+        return NULL;
+    try
+    {
+        // Without an EOF_CHAR the tree is no use for encoding or decoding
+
+        if (lengths[(unsigned char) EOF_CHAR] == 0 ||
+            ! result -> tree.fillInFromLengths(lengths))
+        {
+            delete result;
+            return NULL;
+        }
+    }
+    catch (bad_alloc &)
+    {
+        delete result;
+        return NULL;
+    }
+    return result;
+}
+
+huffman_tree * huffman_tree_read(const unsigned char * treefile,
+                                 size_t length)
+{
+    huffman_tree * result = new (nothrow) huffman_tree;
+    if (result == NULL)
+        return NULL;
+    try
+    {
+        istringstream input(string((const char *) treefile, length));
+        result -> tree.read(input);
+
+        // The whole file must be used, as huffman -c and -d require
+
+        char extra;
+        if (result -> tree.isEmpty() || input.get(extra))
+        {
+            delete result;
+            return NULL;
+        }
+    }
+    catch (bad_alloc &)
+    {
+        delete result;
+        return NULL;
+    }
+    return result;
+}
+
+int huffman_tree_write(const huffman_tree * tree,
+                       unsigned char * treefile, size_t capacity,
+                       size_t * length)
+{
+    *length = 0;
+    if (! tree -> tree.canWrite())
+        return HUFFMAN_BAD_INPUT;
+    try
+    {
+        ostringstream output;
+        tree -> tree.write(output);
+        string contents = output.str();
+        if (contents.size() > capacity)
+            return HUFFMAN_NO_ROOM;
+        contents.copy((char *) treefile, contents.size());
+        *length = contents.size();
+    }
+    catch (bad_alloc &)
+    {
+        return HUFFMAN_NO_MEMORY;
+    }
+    return HUFFMAN_OK;
+}
+
+void huffman_tree_free(huffman_tree * tree)
+{
+    delete tree;
+}
+
+size_t huffman_encode_bound(const huffman_tree * tree, size_t length)
+{
+    return tree -> tree.maxCompressedLength(length);
+}
+
+int huffman_encode(const huffman_tree * tree,
+                   const unsigned char * document, size_t length,
+                   unsigned char * compressed, size_t capacity,
+                   size_t * compressedLength)
+{
+    return status(tree -> tree.compress((const char *) document, length,
+                                        (char *) compressed, capacity,
+                                        * compressedLength));
+}
+
+int huffman_decode(const huffman_tree * tree,
+                   const unsigned char * compressed, size_t length,
+                   unsigned char * document, size_t capacity,
+                   size_t * documentLength)
+{
+    return status(tree -> tree.decompress((const char *) compressed, length,
+                                          (char *) document, capacity,
+                                          * documentLength));
+}
+
+huffman_lz * huffman_lz_create(void)
+{
+    try
+    {
+        return new huffman_lz;
+    }
+    catch (bad_alloc &)
+    {
+        return NULL;
+    }
+}
+
+void huffman_lz_free(huffman_lz * lz)
+{
+    delete lz;
+}
+
+size_t huffman_lz_encode_bound(size_t length)
+{
+    return LZCompressor::maxCompressedLength(length);
+}
+
+int huffman_lz_encode(huffman_lz * lz,
+                      const unsigned char * document, size_t length,
+                      unsigned char * compressed, size_t capacity,
+                      size_t * compressedLength)
+{
+    // The input buffer is only ever read from
+
+    MemoryBuffer inputBuffer((char *) document, length);
+    MemoryBuffer outputBuffer((char *) compressed, capacity);
+    istream input(& inputBuffer);
+    ostream output(& outputBuffer);
+    lz -> compressor.compress(input, output);
+    * compressedLength = outputBuffer.written();
+    return output.good() ? HUFFMAN_OK : HUFFMAN_NO_ROOM;
+}
+
+int huffman_lz_decode(huffman_lz * lz,
+                      const unsigned char * compressed, size_t length,
+                      unsigned char * document, size_t capacity,
+                      size_t * documentLength)
+{
+    MemoryBuffer inputBuffer((char *) compressed, length);
+    MemoryBuffer outputBuffer((char *) document, capacity);
+    istream input(& inputBuffer);
+    ostream output(& outputBuffer);
+    lz -> compressor.decompress(input, output);
+    * documentLength = outputBuffer.written();
+    if (! output.good())
+        return HUFFMAN_NO_ROOM;
+
+    // As for huffman -x, nothing may follow the compressed document
+
+    if (input.fail() || input.get() != EOF)
+        return HUFFMAN_BAD_INPUT;
+    return HUFFMAN_OK;
+}
@@ -0,0 +1,113 @@
+/* huffman_api.h
+ *
+ * C interface to the Huffman tree, for programs that want to compress and
+ * decompress buffers in-process by linking with libhuffman rather than
+ * running the huffman program.
+ *
+ * A tree is created once and may then be shared by any number of threads:
+ * encoding and decoding keep all their state on the stack, write only into
+ * the buffer supplied by the caller, and never allocate memory.
+ */
+
+#ifndef HUFFMAN_API_H
+#define HUFFMAN_API_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Results of the functions below */
+#define HUFFMAN_OK          0
+#define HUFFMAN_NO_ROOM     1   /* Output buffer too small */
+#define HUFFMAN_BAD_INPUT   2   /* Input malformed or not encodable */
+#define HUFFMAN_NO_MEMORY   3   /* Could not allocate a tree */
+
+typedef struct huffman_tree huffman_tree;
+
+/* Create a tree from the frequencies of the bytes in a sample document.
+ * Returns NULL if memory cannot be allocated. */
+huffman_tree * huffman_tree_from_bytes(const unsigned char * document,
+                                       size_t length);
+
+/* Create the canonical tree having the given code length for each byte
+ * (0 meaning the byte does not occur).  Returns NULL if the lengths are not
+ * a complete prefix code, byte 4 (the end marker) has no code, or memory
+ * cannot be allocated. */
+huffman_tree * huffman_tree_from_lengths(const unsigned char lengths[256]);
+
+/* Create a tree from the contents of a tree file, as written by
+ * huffman_tree_write or huffman -f.  Returns NULL if malformed or if the
+ * tree has no end marker. */
+huffman_tree * huffman_tree_read(const unsigned char * treefile,
+                                 size_t length);
+
+/* Write a tree in the tree file format.  At most 511 bytes are needed.
+ * The format marks internal nodes with byte 255, so a tree with a leaf for
+ * that byte cannot be written: HUFFMAN_BAD_INPUT is returned instead. */
+int huffman_tree_write(const huffman_tree * tree,
+                       unsigned char * treefile, size_t capacity,
+                       size_t * length);
+
+/* Free a tree created by one of the above.  NULL is ignored. */
+void huffman_tree_free(huffman_tree * tree);
+
+/* Largest compressed size of a document of the given length, or 0 if the
+ * tree cannot be used for encoding (some code is too long). */
+size_t huffman_encode_bound(const huffman_tree * tree, size_t length);
+
+/* Compress a document, producing the same bytes as huffman -c.  Byte 4 is
+ * the end marker of a compressed document, so the document must not
+ * contain it; the LZ functions below take any bytes.  Returns
+ * HUFFMAN_BAD_INPUT, whatever the capacity, if the document has byte 4 or
+ * a byte the tree has no code for, and otherwise HUFFMAN_NO_ROOM if the
+ * compressed document does not fit. */
+int huffman_encode(const huffman_tree * tree,
+                   const unsigned char * document, size_t length,
+                   unsigned char * compressed, size_t capacity,
+                   size_t * compressedLength);
+
+/* Decompress a document compressed by huffman_encode or huffman -c.
+ * Returns HUFFMAN_NO_ROOM only when the document is longer than capacity,
+ * and HUFFMAN_BAD_INPUT if the input ends before the end marker. */
+int huffman_decode(const huffman_tree * tree,
+                   const unsigned char * compressed, size_t length,
+                   unsigned char * document, size_t capacity,
+                   size_t * documentLength);
+
+/* The functions below compress with an LZ77 stage in front of Huffman
+ * coding, in the format of huffman -z, and need no tree.  They use a
+ * huffman_lz, which holds the window and tables for one document at a
+ * time, so a thread should have one of its own. */
+
+typedef struct huffman_lz huffman_lz;
+
+/* Create the state used by the LZ functions - about 1.5 MB, allocated here
+ * once so that encoding and decoding never allocate.  Returns NULL if
+ * memory cannot be allocated. */
+huffman_lz * huffman_lz_create(void);
+
+/* Free state created by huffman_lz_create.  NULL is ignored. */
+void huffman_lz_free(huffman_lz * lz);
+
+/* Largest compressed size of a document of the given length */
+size_t huffman_lz_encode_bound(size_t length);
+
+/* Compress a document, producing the same bytes as huffman -z */
+int huffman_lz_encode(huffman_lz * lz,
+                      const unsigned char * document, size_t length,
+                      unsigned char * compressed, size_t capacity,
+                      size_t * compressedLength);
+
+/* Decompress a document compressed by huffman_lz_encode or huffman -z */
+int huffman_lz_decode(huffman_lz * lz,
+                      const unsigned char * compressed, size_t length,
+                      unsigned char * document, size_t capacity,
+                      size_t * documentLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
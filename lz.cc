@@ -0,0 +1,444 @@
+/* lz.cc
+ *
+ * Implementation of the LZ77 stage defined in lz.h
+ *
+ * Format of a compressed document: a series of blocks, each starting with
+ * its length (4 characters, most significant first), ended by a length of
+ * 0.  Next comes a character giving the kind of block.  A stored block is
+ * followed by its characters as is.  A coded block is followed by the length
+ * of the coding (4 characters) and then the coding itself, a series of bits:
+ *
+ *  - For each code, in the order of the enum in lz.h: a bitmap of 256 bits
+ *    telling which characters have a code, then 8 bits giving the code
+ *    length of each one that does.  A code with no characters is not used.
+ *  - For each sequence: the literal run length (as written by encodeCount)
+ *    and the literals, then, unless that completes the block, the match
+ *    length less MIN_MATCH (also by encodeCount), then the distance less 1,
+ *    its high 8 bits coded by the distance code and its low 8 bits as is.
+ */
+
+#include "lz.h"
+#include <cstring>
+
+/* Kinds of block */
+#define STORED_BLOCK 's'
+#define CODED_BLOCK 'c'
+
+/* Size of the hash table used for finding matches */
+#define HASH_BITS 15
+#define HASH_SIZE (1 << HASH_BITS)
+/* Most earlier positions looked at for a match - the main tradeoff of
+ * speed against ratio */
+#define MAX_CHAIN 16
+/* A match this long is taken without looking for a longer one */
+#define GOOD_MATCH 64
+
+/* Hash the MIN_MATCH characters starting at text */
+static unsigned hashAt(const char * text)
+{
+    unsigned value = (unsigned char) text[0] |
+                     (unsigned char) text[1] << 8 |
+                     (unsigned char) text[2] << 16 |
+                     (unsigned) (unsigned char) text[3] << 24;
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/* Write a block or coding length to a stream */
+static void writeLength(ostream & output, unsigned long length)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        output.put((char) (length >> shift));
+}
+
+/* Read a length written by writeLength.  Returns false at end of file. */
+static bool readLength(istream & input, unsigned long & length)
+{
+    length = 0;
+    for (int i = 0; i < 4; i ++)
+    {
+        char c;
+        if (! input.get(c))
+            return false;
+        length = (length << 8) | (unsigned char) c;
+    }
+    return true;
+}
+
+LZCompressor::LZCompressor()
+: _window(new char[WINDOW_SIZE + BLOCK_SIZE]),
+  _windowStart(0),
+  _head(new unsigned long long[HASH_SIZE]),
+  _previous(new unsigned long long[WINDOW_SIZE]),
+  _sequences(new Sequence[BLOCK_SIZE / MIN_MATCH + 1]),
+  _sequenceCount(0),
+  _output(new char[BLOCK_SIZE])
+{ }
+
+LZCompressor::~LZCompressor()
+{
+    delete [] _window;
+    delete [] _head;
+    delete [] _previous;
+    delete [] _sequences;
+    delete [] _output;
+}
+
+void LZCompressor::compress(istream & originalDocument,
+                            ostream & compressedDocument)
+{
+    _windowStart = 0;
+    memset(_head, 0, HASH_SIZE * sizeof(_head[0]));
+
+    int filled = 0;
+    while (true)
+    {
+        originalDocument.read(_window + filled, BLOCK_SIZE);
+        int length = originalDocument.gcount();
+        if (length == 0)
+            break;
+
+        int frequencies[CODES][UCHAR_MAX + 1];
+        memset(frequencies, 0, sizeof(frequencies));
+        parseBlock(filled, length, frequencies);
+        size_t codedLength = encodeBlock(filled, length, frequencies);
+
+        writeLength(compressedDocument, length);
+        if (codedLength == 0)
+        {
+            compressedDocument.put(STORED_BLOCK);
+            compressedDocument.write(_window + filled, length);
+        }
+        else
+        {
+            compressedDocument.put(CODED_BLOCK);
+            writeLength(compressedDocument, codedLength);
+            compressedDocument.write(_output, codedLength);
+        }
+        filled = slideWindow(filled + length);
+    }
+    writeLength(compressedDocument, 0);
+}
+
+void LZCompressor::decompress(istream & compressedDocument,
+                              ostream & decompressedDocument)
+{
+    _windowStart = 0;
+
+    int filled = 0;
+    while (true)
+    {
+        unsigned long length, codedLength;
+        char kind;
+        if (! readLength(compressedDocument, length))
+            break;
+        if (length == 0)
+            return;
+        if (length > BLOCK_SIZE || ! compressedDocument.get(kind))
+            break;
+
+        if (kind == STORED_BLOCK)
+        {
+            compressedDocument.read(_window + filled, length);
+            if ((unsigned long) compressedDocument.gcount() != length)
+                break;
+        }
+        else if (kind == CODED_BLOCK)
+        {
+            // The coding is only used when smaller than the block
+
+            if (! readLength(compressedDocument, codedLength) ||
+                codedLength >= length)
+                break;
+            compressedDocument.read(_output, codedLength);
+            if ((unsigned long) compressedDocument.gcount() != codedLength ||
+                ! decodeBlock(_output, codedLength, filled, length))
+                break;
+        }
+        else
+            break;
+
+        decompressedDocument.write(_window + filled, length);
+        if (! decompressedDocument.good())
+            return;
+        filled = slideWindow(filled + length);
+    }
+    compressedDocument.setstate(ios::failbit);
+}
+
+size_t LZCompressor::maxCompressedLength(size_t length)
+{
+    // A block is only coded when that makes it smaller, so each block
+    // grows by at most its header, and the document by the end marker
+
+    size_t blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    return length + blocks * 9 + 4;
+}
+
+void LZCompressor::parseBlock(int start, int length,
+                              int frequencies[CODES][UCHAR_MAX + 1])
+{
+    int end = start + length;
+    int literalStart = start;
+    int position = start;
+    _sequenceCount = 0;
+
+    while (position + MIN_MATCH <= end)
+    {
+        int distance;
+        int matchLength = findMatch(position, end - position, distance);
+        insertPosition(position);
+        if (matchLength == 0)
+        {
+            position ++;
+            continue;
+        }
+
+        Sequence & sequence = _sequences[_sequenceCount ++];
+        sequence.literals = position - literalStart;
+        sequence.matchLength = matchLength;
+        sequence.distance = distance;
+        for (int i = literalStart; i < position; i ++)
+            frequencies[LITERALS][(unsigned char) _window[i]] ++;
+        countCount(frequencies[RUNS], sequence.literals);
+        countCount(frequencies[LENGTHS], matchLength - MIN_MATCH);
+        frequencies[DISTANCES][(distance - 1) >> 8] ++;
+
+        // Later text may match text inside this match too
+
+        for (int i = position + 1;
+             i < position + matchLength && i + MIN_MATCH <= end; i ++)
+            insertPosition(i);
+        position += matchLength;
+        literalStart = position;
+    }
+
+    // Whatever is left over ends the block as a literal run
+
+    Sequence & last = _sequences[_sequenceCount ++];
+    last.literals = end - literalStart;
+    last.matchLength = 0;
+    last.distance = 0;
+    for (int i = literalStart; i < end; i ++)
+        frequencies[LITERALS][(unsigned char) _window[i]] ++;
+    countCount(frequencies[RUNS], last.literals);
+}
+
+int LZCompressor::findMatch(int position, int limit, int & distance) const
+{
+    unsigned long long here = _windowStart + position;
+    unsigned long long candidate = _head[hashAt(_window + position)];
+    int best = 0;
+    for (int chain = 0; candidate != 0 && chain < MAX_CHAIN; chain ++)
+    {
+        unsigned long long there = candidate - 1;
+        if (here - there > WINDOW_SIZE)
+            break;
+
+        // A candidate differing at the end of the best match so far cannot
+        // beat it; others are compared 8 characters at a time
+
+        const char * earlier = _window + (there - _windowStart);
+        const char * current = _window + position;
+        if (best < limit && earlier[best] == current[best])
+        {
+            int length = 0;
+            while (length + 8 <= limit)
+            {
+                unsigned long long a, b;
+                memcpy(&a, earlier + length, 8);
+                memcpy(&b, current + length, 8);
+                if (a != b)
+                    break;
+                length += 8;
+            }
+            while (length < limit && earlier[length] == current[length])
+                length ++;
+            if (length > best)
+            {
+                best = length;
+                distance = here - there;
+                if (best >= GOOD_MATCH || best == limit)
+                    break;
+            }
+        }
+
+        // Entries older than the window may have been overwritten, so
+        // only follow links that lead further back
+
+        unsigned long long next = _previous[there % WINDOW_SIZE];
+        if (next >= candidate)
+            break;
+        candidate = next;
+    }
+    return (best >= MIN_MATCH) ? best : 0;
+}
+
+void LZCompressor::insertPosition(int position)
+{
+    unsigned long long here = _windowStart + position;
+    unsigned hash = hashAt(_window + position);
+    _previous[here % WINDOW_SIZE] = _head[hash];
+    _head[hash] = here + 1;
+}
+
+size_t LZCompressor::encodeBlock(int start, int length,
+                                 const int frequencies[CODES][UCHAR_MAX + 1])
+{
+    BitWriter output(_output, length);
+    bool ok = true;
+
+    for (int t = 0; ok && t < CODES; t ++)
+    {
+        // An unused code has no lengths, and is left empty
+
+        unsigned char lengths[UCHAR_MAX + 1];
+        if (! CanonicalCode::computeLengths(frequencies[t], lengths))
+            return 0;
+        _codes[t].fillInFromLengths(lengths);
+
+        for (int c = 0; ok && c <= UCHAR_MAX; c += 8)
+        {
+            unsigned present = 0;
+            for (int i = 0; i < 8; i ++)
+                present = (present << 1) | (lengths[c + i] > 0);
+            ok = output.insertBits(present, 8);
+        }
+        for (int c = 0; ok && c <= UCHAR_MAX; c ++)
+            if (lengths[c] > 0)
+                ok = output.insertBits(lengths[c], 8);
+    }
+
+    int position = start;
+    for (int s = 0; ok && s < _sequenceCount; s ++)
+    {
+        const Sequence & sequence = _sequences[s];
+        ok = encodeCount(_codes[RUNS], sequence.literals, output);
+        for (int i = 0; ok && i < sequence.literals; i ++)
+            ok = _codes[LITERALS].encode(_window[position ++], output);
+        if (ok && sequence.matchLength > 0)
+        {
+            unsigned distance = sequence.distance - 1;
+            ok = encodeCount(_codes[LENGTHS],
+                             sequence.matchLength - MIN_MATCH, output) &&
+                 _codes[DISTANCES].encode(distance >> 8, output) &&
+                 output.insertBits(distance & 0xFF, 8);
+            position += sequence.matchLength;
+        }
+    }
+
+    // Running out of room means the coding is no smaller than the block
+
+    if (! ok || ! output.flushBits() || output.length() >= (size_t) length)
+        return 0;
+    return output.length();
+}
+
+bool LZCompressor::decodeBlock(const char * coded, size_t codedLength,
+                               int start, int blockLength)
+{
+    BitReader input(coded, codedLength);
+
+    for (int t = 0; t < CODES; t ++)
+    {
+        unsigned char lengths[UCHAR_MAX + 1];
+        bool used = false;
+        for (int c = 0; c <= UCHAR_MAX; c += 8)
+        {
+            unsigned present;
+            if (! input.extractBits(8, present))
+                return false;
+            for (int i = 0; i < 8; i ++)
+                lengths[c + i] = (present >> (7 - i)) & 1;
+            used = used || present != 0;
+        }
+        for (int c = 0; c <= UCHAR_MAX; c ++)
+        {
+            unsigned length;
+            if (lengths[c] > 0)
+            {
+                if (! input.extractBits(8, length))
+                    return false;
+                lengths[c] = length;
+            }
+        }
+
+        // An unused code is left empty, so any attempt to decode with it
+        // fails
+
+        if (! _codes[t].fillInFromLengths(lengths) && used)
+            return false;
+    }
+
+    int position = start;
+    int end = start + blockLength;
+    while (true)
+    {
+        int literals;
+        if (! decodeCount(_codes[RUNS], input, end - position, literals))
+            return false;
+        for (int i = 0; i < literals; i ++)
+            if (! _codes[LITERALS].decode(input, _window[position ++]))
+                return false;
+        if (position == end)
+            return true;
+
+        int matchLength;
+        char high;
+        unsigned low;
+        if (! decodeCount(_codes[LENGTHS], input,
+                          end - position - MIN_MATCH, matchLength) ||
+            ! _codes[DISTANCES].decode(input, high) ||
+            ! input.extractBits(8, low))
+            return false;
+        matchLength += MIN_MATCH;
+        int distance = ((unsigned char) high << 8 | low) + 1;
+        if (distance > position)
+            return false;
+
+        // Copy a character at a time, since the match may overlap itself
+
+        for (int i = 0; i < matchLength; i ++, position ++)
+            _window[position] = _window[position - distance];
+    }
+}
+
+int LZCompressor::slideWindow(int end)
+{
+    if (end <= WINDOW_SIZE)
+        return end;
+    memmove(_window, _window + end - WINDOW_SIZE, WINDOW_SIZE);
+    _windowStart += end - WINDOW_SIZE;
+    return WINDOW_SIZE;
+}
+
+bool LZCompressor::encodeCount(const CanonicalCode & code, int count,
+                               BitWriter & output)
+{
+    for ( ; count >= UCHAR_MAX; count -= UCHAR_MAX)
+        if (! code.encode((char) UCHAR_MAX, output))
+            return false;
+    return code.encode((char) count, output);
+}
+
+bool LZCompressor::decodeCount(const CanonicalCode & code, BitReader & input,
+                               int limit, int & count)
+{
+    count = 0;
+    while (true)
+    {
+        char c;
+        if (! code.decode(input, c))
+            return false;
+        count += (unsigned char) c;
+        if (count > limit)
+            return false;
+        if ((unsigned char) c != UCHAR_MAX)
+            return true;
+    }
+}
+
+void LZCompressor::countCount(int frequencies[UCHAR_MAX + 1], int count)
+{
+    frequencies[UCHAR_MAX] += count / UCHAR_MAX;
+    frequencies[count % UCHAR_MAX] ++;
+}
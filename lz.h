@@ -0,0 +1,120 @@
+/* lz.h
+ *
+ * An LZ77 stage in front of the Huffman coder, for documents with long
+ * repeats that plain character-by-character Huffman coding cannot exploit.
+ *
+ * The document is processed in blocks.  Each block is parsed into
+ * sequences: a run of literal characters followed by a match, i.e. a copy
+ * of earlier text given by a length and a distance back (up to WINDOW_SIZE,
+ * which may reach into previous blocks).  The last sequence of a block has
+ * no match.  Matches are found with a hash chain of bounded length, favoring
+ * speed over the best possible ratio.
+ *
+ * The literal run lengths, literals, match lengths and distances are each
+ * coded with their own canonical Huffman code, computed for the block and
+ * stored at its start as code lengths.  A block that does not get smaller
+ * is stored as is.
+ */
+
+#ifndef LZ_H
+#define LZ_H
+
+#include "huffman.h"
+
+/* Shortest match worth coding */
+#define MIN_MATCH 4
+/* Farthest back a match may be found - distances are coded in 16 bits */
+#define WINDOW_SIZE 65536
+/* Size of document handled at a time */
+#define BLOCK_SIZE 131072
+
+class LZCompressor
+{
+    public:
+
+        /* Constructor - allocates all the memory compress and decompress
+         * will use; the codes for each block are computed in fixed-size
+         * tables, so they never allocate for each block */
+        LZCompressor();
+        ~LZCompressor();
+        /* Compress a document.  Sets the failbit of compressedDocument if
+         * writing fails. */
+        void compress(istream & originalDocument,
+                      ostream & compressedDocument);
+        /* Decompress a document that was compressed by the above.  Sets
+         * the failbit of compressedDocument if it is malformed, and stops
+         * as soon as writing decompressedDocument fails. */
+        void decompress(istream & compressedDocument,
+                        ostream & decompressedDocument);
+        /* Largest number of characters compress can produce for a document
+         * of the given length */
+        static size_t maxCompressedLength(size_t length);
+    private:
+
+        /* The compressors hold large buffers, so they may not be copied */
+        LZCompressor(const LZCompressor &);
+        LZCompressor & operator = (const LZCompressor &);
+
+        /* One literal run and the match following it */
+        struct Sequence
+        {
+            int literals;
+            int matchLength;        // 0 for the last sequence of a block
+            int distance;
+        };
+
+        /* The kinds of values coded, each with a code of its own */
+        enum { RUNS, LITERALS, LENGTHS, DISTANCES, CODES };
+
+        /* Parse the block of length characters starting at _window[start]
+         * into _sequences, counting the values of each kind */
+        void parseBlock(int start, int length,
+                        int frequencies[CODES][UCHAR_MAX + 1]);
+        /* Find the longest match for _window[position], no longer than
+         * limit, returning its length (0 if none) and setting distance */
+        int findMatch(int position, int limit, int & distance) const;
+        /* Enter _window[position] in the hash chains */
+        void insertPosition(int position);
+        /* Code the parsed block starting at _window[start] into _output.
+         * Returns the coded length, or 0 if it would not be smaller than
+         * the block itself. */
+        size_t encodeBlock(int start, int length,
+                           const int frequencies[CODES][UCHAR_MAX + 1]);
+        /* Decode a coded block of blockLength characters into _window at
+         * start.  Returns false if it is malformed. */
+        bool decodeBlock(const char * coded, size_t codedLength,
+                         int start, int blockLength);
+        /* Keep only the last WINDOW_SIZE characters of the first end
+         * characters of _window, moving them to the front.  Returns the
+         * number of characters kept. */
+        int slideWindow(int end);
+
+        /* Write a count as a sequence of characters: any number of 255's
+         * followed by the remainder */
+        static bool encodeCount(const CanonicalCode & code, int count,
+                                BitWriter & output);
+        /* Read a count written by encodeCount, no larger than limit */
+        static bool decodeCount(const CanonicalCode & code, BitReader & input,
+                                int limit, int & count);
+        /* Count the characters encodeCount will write for count */
+        static void countCount(int frequencies[UCHAR_MAX + 1], int count);
+
+        /* The previous WINDOW_SIZE characters followed by the current block */
+        char * _window;
+        /* Position in the whole document of _window[0] */
+        unsigned long long _windowStart;
+        /* Hash chains: _head gives the most recent position (in the whole
+         * document, plus 1) having each hash, and _previous the position
+         * before each one having the same hash */
+        unsigned long long * _head;
+        unsigned long long * _previous;
+        /* The current block, as parsed */
+        Sequence * _sequences;
+        int _sequenceCount;
+        /* A coded block */
+        char * _output;
+        /* One code for each kind of value */
+        CanonicalCode _codes[CODES];
+};
+
+#endif
@@ -8,9 +8,8 @@
 
 #include "huffman.h"
 
-#ifndef INTERNAL_NODE_MARKER
-#define INTERNAL_NODE_MARKER '\377'
-#endif
+HuffmanTree::Node::~Node()
+{ }
 
 HuffmanTree::Node * HuffmanTree::Node::getLChild() const
 { throw "getLChild() called on an improper node type."; }
@@ -21,14 +20,27 @@ HuffmanTree::Node * HuffmanTree::Node::getRChild() const
 char HuffmanTree::Node::getCharacter() const
 { throw "getCharacter() called on an improper node type."; }
 
-HuffmanTree::Node * HuffmanTree::Node::read(istream & treefile)
+HuffmanTree::Node * HuffmanTree::Node::read(istream & treefile, int depth)
 {
+    // A tree has at most one leaf per character, so no well-formed file can
+    // nest deeper than this
+
+    if (depth > UCHAR_MAX)
+        return NULL;
     char character;
-    treefile.get(character);
+    if (! treefile.get(character))
+        return NULL;
     if (character == INTERNAL_NODE_MARKER)
     {
-        Node * lchild = read(treefile);
-        Node * rchild = read(treefile);
+        Node * lchild = read(treefile, depth + 1);
+        if (lchild == NULL)
+            return NULL;
+        Node * rchild = read(treefile, depth + 1);
+        if (rchild == NULL)
+        {
+            delete lchild;
+            return NULL;
+        }
         return new InternalNode(lchild, rchild);
     }
     else
@@ -40,6 +52,12 @@ HuffmanTree::InternalNode::InternalNode(HuffmanTree::Node * lchild,
 : _lchild(lchild), _rchild(rchild)
 { }
 
+HuffmanTree::InternalNode::~InternalNode()
+{
+    delete _lchild;
+    delete _rchild;
+}
+
 bool HuffmanTree::InternalNode::isInternal() const
 { return true; }
 
@@ -61,9 +79,9 @@ HuffmanTree::Node * HuffmanTree::InternalNode::getRChild() const
 { return _rchild; }
 
 void HuffmanTree::InternalNode::fillInCodeTable(
-                     int bits [],
+                     unsigned bits [],
                      int count [],
-                     int bitsSoFar,
+                     unsigned bitsSoFar,
                      int countSoFar) const
 {
     _lchild -> fillInCodeTable(bits,
@@ -96,13 +114,13 @@ char HuffmanTree::LeafNode::getCharacter() const
 { return _character; }
 
 void HuffmanTree::LeafNode::fillInCodeTable(
-                     int bits [],
+                     unsigned bits [],
                      int count [],
-                     int bitsSoFar,
+                     unsigned bitsSoFar,
                      int countSoFar) const
 {
-    bits[_character] = bitsSoFar;
-    count[_character] = countSoFar;
+    bits[(unsigned char) _character] = bitsSoFar;
+    count[(unsigned char) _character] = countSoFar;
 }
 
 bool HuffmanTree::NodeFrequencyComparator::operator() (HuffmanTree::Node * a,
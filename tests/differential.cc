@@ -0,0 +1,188 @@
+/* differential.cc
+ *
+ * Differential tests: each faster path must agree exactly with the
+ * reference it replaces -
+ *  - the buffer forms of HuffmanTree::compress and decompress with the
+ *    stream forms, on valid and corrupted input
+ *  - CanonicalCode's table decoding with the bit-by-bit walk of a
+ *    HuffmanTree built from the same code lengths
+ *  - CanonicalCode::computeLengths with the code HuffmanTree::fillIn
+ *    builds, in total coded length
+ */
+
+#include "huffman.h"
+#include "testing.h"
+#include <sstream>
+#include <vector>
+
+/* Random counts of occurrences, over an alphabet of random size and with
+ * a spread of random width */
+static void makeFrequencies(Random & random, int frequencies[UCHAR_MAX + 1])
+{
+    int alphabet = 1 + random.below(UCHAR_MAX + 1);
+    int spread = 1 + random.below(20);
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+        frequencies[c] = (c < alphabet && random.below(4) != 0)
+                         ? (random.next() >> random.below(spread)) % 100000
+                         : 0;
+}
+
+static void checkStreamsAgree(Random & random)
+{
+    // A document with no EOF_CHAR in it, and its tree
+
+    string document(random.below(5000), ' ');
+    int alphabet = 2 + random.below(100);
+    for (size_t i = 0; i < document.size(); i ++)
+        document[i] = (char) (EOF_CHAR + 1 + random.below(alphabet));
+    HuffmanTree tree;
+    tree.fillIn(document.data(), document.size());
+
+    istringstream original(document);
+    ostringstream streamCompressed;
+    tree.compress(original, streamCompressed);
+    CHECK(streamCompressed.good());
+    string coded = streamCompressed.str();
+
+    vector<char> bufferCompressed(tree.maxCompressedLength(document.size()));
+    size_t codedLength;
+    CHECK(tree.compress(document.data(), document.size(),
+                        & bufferCompressed[0], bufferCompressed.size(),
+                        codedLength) == HuffmanTree::OK);
+    CHECK(string(& bufferCompressed[0], codedLength) == coded);
+
+    // Corrupt some of the coded documents, then both forms of decompress
+    // must produce the same characters and agree on whether it worked.
+    // Every code is at least one bit, so the output has a known bound.
+
+    if (random.below(2) == 0 && ! coded.empty())
+        for (int flips = 1 + random.below(4); flips > 0; flips --)
+            coded[random.below(coded.size())] ^= 1 << random.below(8);
+    if (random.below(4) == 0)
+        coded.resize(random.below(coded.size() + 1));
+
+    istringstream compressed(coded);
+    ostringstream streamDecompressed;
+    tree.decompress(compressed, streamDecompressed);
+    bool streamWorked = ! compressed.fail();
+
+    vector<char> decompressed(coded.size() * BITS_PER_CHARACTER + 1);
+    size_t decompressedLength;
+    HuffmanTree::Result result = tree.decompress(coded.data(), coded.size(),
+                                                 & decompressed[0],
+                                                 decompressed.size(),
+                                                 decompressedLength);
+    CHECK(result != HuffmanTree::NO_ROOM);
+    CHECK((result == HuffmanTree::OK) == streamWorked);
+    CHECK(string(& decompressed[0], decompressedLength) ==
+          streamDecompressed.str());
+}
+
+static void checkCanonicalAgrees(Random & random)
+{
+    int frequencies[UCHAR_MAX + 1];
+    makeFrequencies(random, frequencies);
+    unsigned char lengths[UCHAR_MAX + 1];
+    CHECK(CanonicalCode::computeLengths(frequencies, lengths));
+
+    bool used = false;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+        used = used || lengths[c] > 0;
+    CanonicalCode code;
+    HuffmanTree tree;
+    CHECK(code.fillInFromLengths(lengths) == used);
+    CHECK(tree.fillInFromLengths(lengths) == used);
+    if (! used)
+        return;
+
+    // Both must write the same bits for the same characters
+
+    vector<char> symbols;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+        if (lengths[c] > 0)
+            symbols.push_back((char) c);
+    string document;
+    for (int i = random.below(3000); i > 0; i --)
+        document += symbols[random.below(symbols.size())];
+
+    vector<char> fromCode(document.size() * 4 + 1), fromTree(fromCode.size());
+    BitWriter codeOutput(& fromCode[0], fromCode.size());
+    BitWriter treeOutput(& fromTree[0], fromTree.size());
+    for (size_t i = 0; i < document.size(); i ++)
+    {
+        CHECK(code.encode(document[i], codeOutput));
+        CHECK(tree.encode(document[i], treeOutput));
+    }
+    CHECK(codeOutput.flushBits() && treeOutput.flushBits());
+    CHECK(codeOutput.length() == treeOutput.length());
+    CHECK(fromCode == fromTree);
+
+    // Both must read the same characters from any bits, and run out of
+    // input at the same point
+
+    string bits(fromCode.begin(), fromCode.begin() + codeOutput.length());
+    if (random.below(2) == 0)
+        for (size_t i = 0; i < bits.size(); i ++)
+            bits[i] = (char) random.next();
+    BitReader codeInput(bits.data(), bits.size());
+    BitReader treeInput(bits.data(), bits.size());
+    while (true)
+    {
+        char fromCodeCharacter, fromTreeCharacter;
+        bool codeRead = code.decode(codeInput, fromCodeCharacter);
+        bool treeRead = tree.decode(treeInput, fromTreeCharacter);
+        CHECK(codeRead == treeRead);
+        if (! codeRead)
+            break;
+        CHECK(fromCodeCharacter == fromTreeCharacter);
+    }
+}
+
+static void checkLengthsOptimal(Random & random)
+{
+    // Huffman codes need not be unique, but their total coded length is
+
+    int frequencies[UCHAR_MAX + 1];
+    makeFrequencies(random, frequencies);
+    int present = 0;
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+        present += frequencies[c] > 0;
+    if (present < 2)
+        return;
+
+    unsigned char lengths[UCHAR_MAX + 1];
+    CHECK(CanonicalCode::computeLengths(frequencies, lengths));
+    HuffmanTree tree;
+    tree.fillIn(frequencies);
+
+    // A code written BITS_PER_CHARACTER times fills exactly as many
+    // characters as it has bits
+
+    unsigned long long canonicalBits = 0, treeBits = 0;
+    char scratch[MAX_CODE_LENGTH];
+    for (int c = 0; c <= UCHAR_MAX; c ++)
+    {
+        if (frequencies[c] == 0)
+            continue;
+        BitWriter output(scratch, sizeof scratch);
+        for (int i = 0; i < BITS_PER_CHARACTER; i ++)
+            CHECK(tree.encode((char) c, output));
+        treeBits += (unsigned long long) frequencies[c] * output.length();
+        canonicalBits += (unsigned long long) frequencies[c] * lengths[c];
+    }
+    CHECK(canonicalBits == treeBits);
+}
+
+int main()
+{
+    Random random(2);
+    const int rounds = 2000;
+    for (int i = 0; i < rounds; i ++)
+    {
+        checkStreamsAgree(random);
+        checkCanonicalAgrees(random);
+        checkLengthsOptimal(random);
+    }
+    printf("differential: %d rounds passed\n", rounds);
+    return 0;
+}
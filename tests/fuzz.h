@@ -0,0 +1,22 @@
+/* fuzz.h
+ *
+ * Interface of the fuzz targets.  Each fuzz_*.cc defines both functions;
+ * built with -fsanitize=fuzzer (make fuzz) the target is driven by
+ * libFuzzer, and otherwise by fuzz_main.cc, which make check runs.
+ */
+
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* Try one input.  Returns 0; any invariant that fails stops the program. */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size);
+
+/* Valid inputs to start from when mutating */
+void fuzzSeeds(std::vector<std::string> & seeds);
+
+#endif
@@ -0,0 +1,79 @@
+/* fuzz_decode.cc
+ *
+ * Fuzz target for huffman_decode: the first character of the input is the
+ * length of a tree file that follows it, and the rest is decoded with that
+ * tree, or a fixed one if the tree file is rejected.  Decoding must stay
+ * within its buffer, and whatever decodes must encode and decode again to
+ * the same thing.
+ */
+
+#include "huffman_api.h"
+#include "fuzz.h"
+#include "testing.h"
+#include <cstring>
+
+static const char sample[] = "It was the best of times, it was the worst "
+                             "of times, it was the age of wisdom...";
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size)
+{
+    static huffman_tree * fixedTree = huffman_tree_from_bytes(
+        (const unsigned char *) sample, sizeof sample - 1);
+    if (size == 0)
+        return 0;
+
+    size_t treeLength = data[0] < size - 1 ? data[0] : size - 1;
+    huffman_tree * tree = huffman_tree_read(data + 1, treeLength);
+    const huffman_tree * used = (tree != NULL) ? tree : fixedTree;
+    const uint8_t * compressed = data + 1 + treeLength;
+    size_t compressedLength = size - 1 - treeLength;
+
+    // Every code is at least one bit, so this is always room enough; a
+    // guard after it catches any write beyond the capacity given
+
+    size_t capacity = compressedLength * 8;
+    vector<unsigned char> decompressed(capacity + 1, 0xA5);
+    size_t decompressedLength;
+    int result = huffman_decode(used, compressed, compressedLength,
+                                & decompressed[0], capacity,
+                                & decompressedLength);
+    CHECK(result == HUFFMAN_OK || result == HUFFMAN_BAD_INPUT);
+    CHECK(decompressedLength <= capacity);
+    CHECK(decompressed[capacity] == 0xA5);
+
+    if (result == HUFFMAN_OK && huffman_encode_bound(used, decompressedLength))
+    {
+        size_t bound = huffman_encode_bound(used, decompressedLength);
+        vector<unsigned char> again(bound), back(decompressedLength + 1);
+        size_t againLength, backLength;
+        CHECK(huffman_encode(used, & decompressed[0], decompressedLength,
+                             & again[0], bound, & againLength) == HUFFMAN_OK);
+        CHECK(huffman_decode(used, & again[0], againLength, & back[0],
+                             back.size(), & backLength) == HUFFMAN_OK);
+        CHECK(backLength == decompressedLength &&
+              memcmp(& back[0], & decompressed[0], backLength) == 0);
+    }
+    huffman_tree_free(tree);
+    return 0;
+}
+
+void fuzzSeeds(vector<string> & seeds)
+{
+    huffman_tree * tree = huffman_tree_from_bytes(
+        (const unsigned char *) sample, sizeof sample - 1);
+    unsigned char image[511], compressed[256];
+    size_t imageLength, compressedLength;
+    CHECK(huffman_tree_write(tree, image, sizeof image, & imageLength)
+          == HUFFMAN_OK);
+    CHECK(huffman_encode(tree, (const unsigned char *) sample,
+                         sizeof sample - 1, compressed, sizeof compressed,
+                         & compressedLength) == HUFFMAN_OK);
+
+    // With the tree given in the input, and with the fixed tree
+
+    string coded((char *) compressed, compressedLength);
+    seeds.push_back(string(1, (char) imageLength) +
+                    string((char *) image, imageLength) + coded);
+    seeds.push_back(string(1, '\0') + coded);
+    huffman_tree_free(tree);
+}
@@ -0,0 +1,66 @@
+/* fuzz_lz_decode.cc
+ *
+ * Fuzz target for huffman_lz_decode, the in-process form of huffman -x:
+ * decoding must stay within its buffer, and whatever decodes must encode
+ * and decode again to the same thing.
+ */
+
+#include "huffman_api.h"
+#include "fuzz.h"
+#include "testing.h"
+#include <cstring>
+
+/* Most output tried for one input */
+#define CAPACITY (1 << 20)
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size)
+{
+    static huffman_lz * lz = huffman_lz_create();
+    static vector<unsigned char> decompressed(CAPACITY + 1);
+    static vector<unsigned char> again(huffman_lz_encode_bound(CAPACITY));
+    static vector<unsigned char> back(CAPACITY);
+
+    decompressed[CAPACITY] = 0xA5;
+    size_t decompressedLength;
+    int result = huffman_lz_decode(lz, data, size, & decompressed[0], CAPACITY,
+                                   & decompressedLength);
+    CHECK(result == HUFFMAN_OK || result == HUFFMAN_BAD_INPUT ||
+          result == HUFFMAN_NO_ROOM);
+    CHECK(decompressedLength <= CAPACITY);
+    CHECK(decompressed[CAPACITY] == 0xA5);
+
+    if (result == HUFFMAN_OK)
+    {
+        size_t againLength, backLength;
+        CHECK(huffman_lz_encode(lz, & decompressed[0], decompressedLength,
+                                & again[0], again.size(), & againLength)
+              == HUFFMAN_OK);
+        CHECK(huffman_lz_decode(lz, & again[0], againLength, & back[0],
+                                back.size(), & backLength) == HUFFMAN_OK);
+        CHECK(backLength == decompressedLength &&
+              memcmp(& back[0], & decompressed[0], backLength) == 0);
+    }
+    return 0;
+}
+
+void fuzzSeeds(vector<string> & seeds)
+{
+    // Compressed forms of a log, which has coded blocks, and of text too
+    // short to shrink, which gives a stored block
+
+    huffman_lz * lz = huffman_lz_create();
+    string documents[] = { logDocument(20000, 4), "abc" };
+    for (size_t i = 0; i < sizeof documents / sizeof documents[0]; i ++)
+    {
+        vector<unsigned char> compressed(
+            huffman_lz_encode_bound(documents[i].size()));
+        size_t compressedLength;
+        CHECK(huffman_lz_encode(lz,
+                                (const unsigned char *) documents[i].data(),
+                                documents[i].size(), & compressed[0],
+                                compressed.size(), & compressedLength)
+              == HUFFMAN_OK);
+        seeds.push_back(string((char *) & compressed[0], compressedLength));
+    }
+    huffman_lz_free(lz);
+}
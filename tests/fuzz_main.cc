@@ -0,0 +1,86 @@
+/* fuzz_main.cc
+ *
+ * Runs a fuzz target without libFuzzer: on the files named on the command
+ * line if any, or else on a fixed series of mutations of the target's
+ * seeds, so that make check gives the same result every time.
+ */
+
+#include "fuzz.h"
+#include "testing.h"
+#include <fstream>
+#include <sstream>
+
+/* Number of inputs tried when no files are named */
+#define RUNS 20000
+
+/* Change an input at random: flip, overwrite, insert or remove characters,
+ * or cut it short */
+static void mutate(string & input, Random & random)
+{
+    for (int changes = 1 + random.below(8); changes > 0; changes --)
+    {
+        size_t position = input.empty() ? 0 : random.below(input.size());
+        switch (random.below(5))
+        {
+            case 0:
+                if (! input.empty())
+                    input[position] ^= 1 << random.below(8);
+                break;
+            case 1:
+                if (! input.empty())
+                    input[position] = (char) random.next();
+                break;
+            case 2:
+                input.insert(position, 1 + random.below(4), (char) random.next());
+                break;
+            case 3:
+                input.erase(position, 1 + random.below(4));
+                break;
+            case 4:
+                input.resize(position);
+                break;
+        }
+    }
+}
+
+static void run(const string & input)
+{
+    LLVMFuzzerTestOneInput((const uint8_t *) input.data(), input.size());
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i ++)
+        {
+            ifstream file(argv[i], ios::in | ios::binary);
+            CHECK(file.good());
+            ostringstream contents;
+            contents << file.rdbuf();
+            run(contents.str());
+        }
+        return 0;
+    }
+
+    vector<string> seeds;
+    fuzzSeeds(seeds);
+    Random random(3);
+    for (size_t i = 0; i < seeds.size(); i ++)
+        run(seeds[i]);
+    for (int i = 0; i < RUNS; i ++)
+    {
+        string input;
+        if (i % 10 == 0)
+            for (int length = random.below(64); length > 0; length --)
+                input += (char) random.next();
+        else
+        {
+            input = seeds[random.below(seeds.size())];
+            mutate(input, random);
+        }
+        run(input);
+    }
+    printf("%s: %d inputs passed\n", argv[0], RUNS + (int) seeds.size());
+    return 0;
+}
@@ -0,0 +1,76 @@
+/* fuzz_tree_read.cc
+ *
+ * Fuzz target for huffman_tree_read, and so for Node::read: any input must
+ * be rejected or give a tree that writes back as the same file and can
+ * compress and decompress.
+ */
+
+#include "huffman_api.h"
+#include "fuzz.h"
+#include "testing.h"
+#include <cstring>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size)
+{
+    huffman_tree * tree = huffman_tree_read(data, size);
+    if (tree == NULL)
+        return 0;
+
+    // Nothing may follow the tree, so it must write back the same
+
+    unsigned char image[511];
+    size_t imageLength;
+    CHECK(huffman_tree_write(tree, image, sizeof image, & imageLength)
+          == HUFFMAN_OK);
+    CHECK(imageLength == size && memcmp(image, data, size) == 0);
+
+    // Compressing the characters of the file itself, where the tree can
+    // encode them, must round-trip
+
+    unsigned char document[511], compressed[4096], decompressed[511];
+    size_t length = 0, compressedLength, decompressedLength;
+    for (size_t i = 0; i < size; i ++)
+    {
+        document[length] = data[i];
+        size_t ignored;
+        if (huffman_encode(tree, document + length, 1, compressed,
+                           sizeof compressed, & ignored) == HUFFMAN_OK)
+            length ++;
+    }
+    int result = huffman_encode(tree, document, length, compressed,
+                                sizeof compressed, & compressedLength);
+    if (result == HUFFMAN_OK)
+    {
+        CHECK(huffman_decode(tree, compressed, compressedLength,
+                             decompressed, sizeof decompressed,
+                             & decompressedLength) == HUFFMAN_OK);
+        CHECK(decompressedLength == length &&
+              memcmp(decompressed, document, length) == 0);
+    }
+    else
+    {
+        // Only a tree with codes too long to encode with may refuse
+        CHECK(huffman_encode_bound(tree, length) == 0);
+    }
+    huffman_tree_free(tree);
+    return 0;
+}
+
+void fuzzSeeds(vector<string> & seeds)
+{
+    // Trees written for a few documents
+
+    const char * documents[] = { "", "a", "abracadabra",
+                                 "the quick brown fox jumps over the lazy dog" };
+    for (size_t i = 0; i < sizeof documents / sizeof documents[0]; i ++)
+    {
+        huffman_tree * tree = huffman_tree_from_bytes(
+            (const unsigned char *) documents[i], strlen(documents[i]));
+        unsigned char image[511];
+        size_t imageLength;
+        CHECK(huffman_tree_write(tree, image, sizeof image, & imageLength)
+              == HUFFMAN_OK);
+        seeds.push_back(string((char *) image, imageLength));
+        huffman_tree_free(tree);
+    }
+}
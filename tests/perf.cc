@@ -0,0 +1,137 @@
+/* perf.cc
+ *
+ * Performance checks on a fixed corpus: each coder must keep up a minimum
+ * throughput, and once set up, encoding and decoding must not allocate.
+ *
+ * The minimum rates are well below what an optimized build achieves, so
+ * that only a real regression - not a busy machine - fails them.
+ */
+
+#include "huffman_api.h"
+#include "testing.h"
+#include <ctime>
+#include <new>
+#include <vector>
+
+/* Size of the fixed corpus */
+#define CORPUS_SIZE (8 << 20)
+
+/* Minimum rates, in MB of document per second */
+#define MIN_ENCODE_RATE 40.0
+#define MIN_DECODE_RATE 5.0
+#define MIN_LZ_ENCODE_RATE 15.0
+#define MIN_LZ_DECODE_RATE 50.0
+
+/* Count of calls to operator new, to check for allocation */
+static unsigned long allocations = 0;
+
+void * operator new(size_t size)
+{
+    allocations ++;
+    void * result = malloc(size ? size : 1);
+    if (result == NULL)
+        throw bad_alloc();
+    return result;
+}
+
+void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void * pointer) throw()
+{
+    free(pointer);
+}
+
+void operator delete[](void * pointer) throw()
+{
+    free(pointer);
+}
+
+void operator delete(void * pointer, size_t) throw()
+{
+    free(pointer);
+}
+
+void operator delete[](void * pointer, size_t) throw()
+{
+    free(pointer);
+}
+
+/* Report the rate of one timed run and check it against the minimum */
+static void checkRate(const char * what, clock_t start, double minimum)
+{
+    double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    double rate = CORPUS_SIZE / 1e6 / (seconds > 0 ? seconds : 1e-9);
+    printf("perf: %-10s %8.1f MB/s (minimum %.0f)\n", what, rate, minimum);
+    CHECK(rate >= minimum);
+}
+
+int main()
+{
+    string corpus = logDocument(CORPUS_SIZE, 1);
+    const unsigned char * document = (const unsigned char *) corpus.data();
+    vector<unsigned char> compressed(CORPUS_SIZE * 2), decompressed(CORPUS_SIZE);
+    size_t compressedLength, decompressedLength;
+    unsigned long before;
+    clock_t start;
+
+    // Huffman coding - the first call of each kind is not timed, so that
+    // the rest is the steady state
+
+    before = allocations;
+    huffman_tree * tree = huffman_tree_from_bytes(document, CORPUS_SIZE);
+    CHECK(tree != NULL);
+    CHECK(allocations > before);    // Building a tree allocates its nodes
+    CHECK(huffman_encode(tree, document, CORPUS_SIZE, & compressed[0],
+                         compressed.size(), & compressedLength) == HUFFMAN_OK);
+    CHECK(huffman_decode(tree, & compressed[0], compressedLength,
+                         & decompressed[0], CORPUS_SIZE,
+                         & decompressedLength) == HUFFMAN_OK);
+
+    before = allocations;
+    start = clock();
+    CHECK(huffman_encode(tree, document, CORPUS_SIZE, & compressed[0],
+                         compressed.size(), & compressedLength) == HUFFMAN_OK);
+    checkRate("encode", start, MIN_ENCODE_RATE);
+    CHECK(allocations == before);
+
+    before = allocations;
+    start = clock();
+    CHECK(huffman_decode(tree, & compressed[0], compressedLength,
+                         & decompressed[0], CORPUS_SIZE,
+                         & decompressedLength) == HUFFMAN_OK);
+    checkRate("decode", start, MIN_DECODE_RATE);
+    CHECK(allocations == before);
+    CHECK(decompressedLength == CORPUS_SIZE);
+    huffman_tree_free(tree);
+
+    // The LZ stage
+
+    huffman_lz * lz = huffman_lz_create();
+    CHECK(lz != NULL);
+    CHECK(huffman_lz_encode(lz, document, CORPUS_SIZE, & compressed[0],
+                            compressed.size(), & compressedLength)
+          == HUFFMAN_OK);
+
+    before = allocations;
+    start = clock();
+    CHECK(huffman_lz_encode(lz, document, CORPUS_SIZE, & compressed[0],
+                            compressed.size(), & compressedLength)
+          == HUFFMAN_OK);
+    checkRate("lz encode", start, MIN_LZ_ENCODE_RATE);
+    CHECK(allocations == before);
+
+    before = allocations;
+    start = clock();
+    CHECK(huffman_lz_decode(lz, & compressed[0], compressedLength,
+                            & decompressed[0], CORPUS_SIZE,
+                            & decompressedLength) == HUFFMAN_OK);
+    checkRate("lz decode", start, MIN_LZ_DECODE_RATE);
+    CHECK(allocations == before);
+    CHECK(decompressedLength == CORPUS_SIZE);
+    CHECK(string((char *) & decompressed[0], CORPUS_SIZE) == corpus);
+    huffman_lz_free(lz);
+    return 0;
+}
@@ -0,0 +1,212 @@
+/* roundtrip.cc
+ *
+ * Round-trip tests: documents of many kinds and lengths must come back
+ * unchanged from huffman_encode / huffman_decode and from LZCompressor,
+ * and the error results must be the documented ones.
+ */
+
+#include "huffman_api.h"
+#include "huffman.h"
+#include "lz.h"
+#include "testing.h"
+#include <sstream>
+#include <vector>
+
+/* Kinds of document to try */
+enum { RANDOM_BYTES, SKEWED_TEXT, LONG_RUNS, LOG_LINES, ONE_CHARACTER, KINDS };
+
+static string makeDocument(int kind, size_t length, Random & random)
+{
+    string document;
+    switch (kind)
+    {
+        case RANDOM_BYTES:
+            while (document.size() < length)
+                document += (char) random.next();
+            break;
+        case SKEWED_TEXT:
+            while (document.size() < length)
+                document += (char) ('a' + random.below(1 + random.below(26)));
+            break;
+        case LONG_RUNS:
+            while (document.size() < length)
+                document.append(1 + random.below(1000),
+                                (char) random.below(4));
+            break;
+        case LOG_LINES:
+            document = logDocument(length, random.next());
+            break;
+        case ONE_CHARACTER:
+            document.assign(length, (char) random.next());
+            break;
+    }
+    document.resize(length);
+    return document;
+}
+
+/* Lengths to try - small ones, and ones either side of the LZ block and
+ * window sizes */
+static const size_t lengths[] =
+{
+    0, 1, 2, 3, 7, 100, 4096,
+    WINDOW_SIZE - 1, WINDOW_SIZE + 1,
+    BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE + 1, 3 * BLOCK_SIZE + 7
+};
+
+static void checkHuffman(const string & original)
+{
+    // EOF_CHAR ends a compressed document, so one that contains it must be
+    // refused rather than cut short, however small the buffer; the rest of
+    // the checks use the document without it
+
+    const unsigned char * bytes = (const unsigned char *) original.data();
+    size_t length = original.size();
+    huffman_tree * tree = huffman_tree_from_bytes(bytes, length);
+    CHECK(tree != NULL);
+    string document;
+    for (size_t i = 0; i < original.size(); i ++)
+        if (original[i] != EOF_CHAR)
+            document += original[i];
+    if (document.size() != original.size())
+    {
+        vector<unsigned char> compressed(huffman_encode_bound(tree, length));
+        size_t compressedLength;
+        CHECK(huffman_encode(tree, bytes, length, & compressed[0],
+                             compressed.size(), & compressedLength)
+              == HUFFMAN_BAD_INPUT);
+        CHECK(huffman_encode(tree, bytes, length, & compressed[0], 0,
+                             & compressedLength) == HUFFMAN_BAD_INPUT);
+        huffman_tree_free(tree);
+        bytes = (const unsigned char *) document.data();
+        length = document.size();
+        tree = huffman_tree_from_bytes(bytes, length);
+        CHECK(tree != NULL);
+    }
+
+    size_t bound = huffman_encode_bound(tree, length);
+    vector<unsigned char> compressed(bound), decompressed(length + 1);
+    size_t compressedLength, decompressedLength;
+    CHECK(huffman_encode(tree, bytes, length, & compressed[0], bound,
+                         & compressedLength) == HUFFMAN_OK);
+    CHECK(compressedLength <= bound);
+    CHECK(huffman_decode(tree, & compressed[0], compressedLength,
+                         & decompressed[0], length, & decompressedLength)
+          == HUFFMAN_OK);
+    CHECK(decompressedLength == length);
+    CHECK(string((char *) & decompressed[0], length) == document);
+
+    if (length > 0)
+    {
+        CHECK(huffman_decode(tree, & compressed[0], compressedLength,
+                             & decompressed[0], length - 1,
+                             & decompressedLength) == HUFFMAN_NO_ROOM);
+        CHECK(huffman_encode(tree, bytes, length, & compressed[0],
+                             compressedLength - 1, & decompressedLength)
+              == HUFFMAN_NO_ROOM);
+    }
+    CHECK(huffman_decode(tree, & compressed[0], compressedLength - 1,
+                         & decompressed[0], length + 1,
+                         & decompressedLength) == HUFFMAN_BAD_INPUT);
+
+    // A character not in the tree must be reported as such, not as a lack
+    // of room, however small the buffer.  (A character not in the document
+    // may still be in the tree, as the partner of a lone character.)
+
+    unsigned char missing = EOF_CHAR + 1, scratch[MAX_CODE_LENGTH];
+    size_t scratchLength;
+    while (missing < UCHAR_MAX &&
+           huffman_encode(tree, & missing, 1, scratch, sizeof scratch,
+                          & scratchLength) != HUFFMAN_BAD_INPUT)
+        missing ++;
+    if (huffman_encode(tree, & missing, 1, scratch, sizeof scratch,
+                       & scratchLength) == HUFFMAN_BAD_INPUT)
+    {
+        string extended = document + (char) missing;
+        CHECK(huffman_encode(tree, (const unsigned char *) extended.data(),
+                             extended.size(), scratch, 0, & scratchLength)
+              == HUFFMAN_BAD_INPUT);
+    }
+
+    // A tree written and read back must compress the same way, unless it
+    // has a leaf for the internal node marker, which cannot be written
+
+    unsigned char image[511];
+    size_t imageLength;
+    if (document.find('\377') != string::npos)
+        CHECK(huffman_tree_write(tree, image, sizeof image, & imageLength)
+              == HUFFMAN_BAD_INPUT);
+    else
+    {
+        CHECK(huffman_tree_write(tree, image, sizeof image, & imageLength)
+              == HUFFMAN_OK);
+        huffman_tree * copy = huffman_tree_read(image, imageLength);
+        CHECK(copy != NULL);
+        vector<unsigned char> again(bound);
+        size_t againLength;
+        CHECK(huffman_encode(copy, bytes, length, & again[0], bound,
+                             & againLength) == HUFFMAN_OK);
+        CHECK(againLength == compressedLength);
+        CHECK(again == compressed);
+        huffman_tree_free(copy);
+    }
+    huffman_tree_free(tree);
+}
+
+static void checkLZ(huffman_lz * lz, const string & document)
+{
+    const unsigned char * bytes = (const unsigned char *) document.data();
+    size_t length = document.size();
+
+    size_t bound = huffman_lz_encode_bound(length);
+    vector<unsigned char> compressed(bound), decompressed(length + 1);
+    size_t compressedLength, decompressedLength;
+    CHECK(huffman_lz_encode(lz, bytes, length, & compressed[0], bound,
+                            & compressedLength) == HUFFMAN_OK);
+    CHECK(compressedLength <= bound);
+    CHECK(huffman_lz_decode(lz, & compressed[0], compressedLength,
+                            & decompressed[0], length + 1,
+                            & decompressedLength) == HUFFMAN_OK);
+    CHECK(decompressedLength == length);
+    CHECK(string((char *) & decompressed[0], length) == document);
+
+    if (length > 0)
+        CHECK(huffman_lz_decode(lz, & compressed[0], compressedLength,
+                                & decompressed[0], length - 1,
+                                & decompressedLength) == HUFFMAN_NO_ROOM);
+    CHECK(huffman_lz_decode(lz, & compressed[0], compressedLength - 1,
+                            & decompressed[0], length + 1,
+                            & decompressedLength) == HUFFMAN_BAD_INPUT);
+
+    // The stream forms must produce the same bytes
+
+    LZCompressor compressor;
+    istringstream original(document);
+    ostringstream coded;
+    compressor.compress(original, coded);
+    CHECK(coded.good());
+    CHECK(coded.str() == string((char *) & compressed[0], compressedLength));
+    istringstream codedInput(coded.str());
+    ostringstream decoded;
+    compressor.decompress(codedInput, decoded);
+    CHECK(! codedInput.fail());
+    CHECK(decoded.str() == document);
+}
+
+int main()
+{
+    huffman_lz * lz = huffman_lz_create();
+    CHECK(lz != NULL);
+    Random random(1);
+    int documents = 0;
+    for (int kind = 0; kind < KINDS; kind ++)
+        for (size_t i = 0; i < sizeof lengths / sizeof lengths[0]; i ++)
+        {
+            string document = makeDocument(kind, lengths[i], random);
+            checkHuffman(document);
+            checkLZ(lz, document);
+            documents ++;
+        }
+    huffman_lz_free(lz);
+    printf("roundtrip: %d documents passed\n", documents);
+    return 0;
+}
@@ -0,0 +1,80 @@
+/* testing.h
+ *
+ * Helpers shared by the tests run by make check
+ */
+
+#ifndef TESTING_H
+#define TESTING_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+using namespace std;
+
+/* Stop the test, reporting where, if a condition does not hold */
+#define CHECK(condition) \
+    do \
+    { \
+        if (! (condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", \
+                    __FILE__, __LINE__, #condition); \
+            exit(1); \
+        } \
+    } while (0)
+
+/* A small pseudo-random generator, so that every run of a test uses the
+ * same inputs */
+class Random
+{
+    public:
+    
+        Random(unsigned long long seed)
+        : _state(seed * 2862933555777941757ULL + 3037000493ULL)
+        { }
+        
+        /* Next value, uniform over all unsigned values */
+        unsigned next()
+        {
+            _state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return _state >> 33;
+        }
+        
+        /* Next value, uniform over 0 .. limit - 1 */
+        unsigned below(unsigned limit)
+        { return next() % limit; }
+        
+    private:
+    
+        unsigned long long _state;
+};
+
+/* A document resembling a server log - timestamps, host names and request
+ * lines - of the given length.  With a fixed seed this is the fixed corpus
+ * used for throughput checks. */
+inline string logDocument(size_t length, unsigned long long seed)
+{
+    static const char * levels[] = { "INFO", "INFO", "INFO", "WARN", "ERROR" };
+    static const int statuses[] = { 200, 200, 200, 304, 404, 500 };
+    Random random(seed);
+    string document;
+    unsigned seconds = 0;
+    char line[200];
+    while (document.size() < length)
+    {
+        seconds += random.below(3);
+        snprintf(line, sizeof line,
+                 "2023-11-14T%02u:%02u:%02u.%03uZ web-%02u.prod.example.com %s "
+                 "request id=%08x path=/api/v1/items/%u status=%d "
+                 "latency_ms=%u\n",
+                 seconds / 3600 % 24, seconds / 60 % 60, seconds % 60,
+                 random.below(1000), random.below(20),
+                 levels[random.below(5)], random.next(), random.below(500),
+                 statuses[random.below(6)], random.below(900));
+        document += line;
+    }
+    document.resize(length);
+    return document;
+}
+
+#endif